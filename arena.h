@@ -0,0 +1,168 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <vector>
+
+// Arena lineal para la memoria temporal de cada cuadro. Las etapas del
+// pipeline piden memoria aquí y todo se libera de una vez al empezar el
+// siguiente cuadro. Si un cuadro no cabe, lo que sobra se pide al heap y en
+// el siguiente reinicio el bloque crece para que ya no haga falta.
+constexpr size_t FRAME_ARENA_INITIAL_SIZE = 4 << 20;
+
+struct FrameArena {
+    std::unique_ptr<std::byte[]> block;
+    size_t capacity = 0;
+    size_t used = 0;
+
+    size_t requested = 0; // bytes pedidos en el cuadro, incluyendo el desborde
+    std::vector<std::unique_ptr<std::byte[]>> overflow;
+};
+
+FrameArena frameArena;
+
+void* arenaAllocate(FrameArena& arena, size_t bytes, size_t alignment) {
+    arena.requested += bytes + alignment;
+
+    size_t offset = (arena.used + alignment - 1) & ~(alignment - 1);
+    if (offset + bytes <= arena.capacity) {
+        arena.used = offset + bytes;
+        return arena.block.get() + offset;
+    }
+
+    // No cabe: se usa un bloque aparte solo para este cuadro
+    arena.overflow.emplace_back(new std::byte[bytes + alignment]);
+    std::byte* start = arena.overflow.back().get();
+    size_t misalignment = reinterpret_cast<uintptr_t>(start) & (alignment - 1);
+    return misalignment ? start + (alignment - misalignment) : start;
+}
+
+// Se llama al inicio de cada cuadro; nada de lo que se pidió antes puede
+// seguir en uso.
+void resetFrameArena(FrameArena& arena) {
+    if (!arena.block || !arena.overflow.empty()) {
+        size_t capacity = std::max(FRAME_ARENA_INITIAL_SIZE, arena.capacity);
+        while (capacity < arena.requested) {
+            capacity *= 2;
+        }
+
+        arena.block.reset(new std::byte[capacity]);
+        arena.capacity = capacity;
+        arena.overflow.clear();
+    }
+
+    arena.used = 0;
+    arena.requested = 0;
+}
+
+// Allocator para contenedores estándar. Liberar no hace nada: la memoria se
+// recupera al reiniciar el arena.
+template <typename T>
+struct ArenaAllocator {
+    using value_type = T;
+
+    ArenaAllocator() = default;
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>&) {}
+
+    T* allocate(size_t count) {
+        return static_cast<T*>(arenaAllocate(frameArena, count * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T*, size_t) {}
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>&) const { return true; }
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>&) const { return false; }
+};
+
+template <typename T>
+using FrameVector = std::vector<T, ArenaAllocator<T>>;
+
+// Contador de llamadas a new para comprobar que un cuadro estable no toca el
+// heap. Reemplaza los operadores globales, así que solo se compila si se
+// pide con TRACK_ALLOCATIONS (la opción de CMake del mismo nombre).
+#ifdef TRACK_ALLOCATIONS
+std::atomic<size_t> heapAllocations{0};
+
+// Con alineación mayor a la de malloc se pide de más y el puntero original
+// se guarda justo antes del bloque alineado
+void* trackedAllocate(size_t bytes, size_t alignment) {
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (alignment <= alignof(std::max_align_t)) {
+        if (void* pointer = std::malloc(bytes ? bytes : 1)) {
+            return pointer;
+        }
+        throw std::bad_alloc();
+    }
+
+    void* original = std::malloc(bytes + alignment + sizeof(void*));
+    if (!original) {
+        throw std::bad_alloc();
+    }
+    uintptr_t address = reinterpret_cast<uintptr_t>(original) + sizeof(void*);
+    void* aligned = reinterpret_cast<void*>((address + alignment - 1) & ~(alignment - 1));
+    static_cast<void**>(aligned)[-1] = original;
+    return aligned;
+}
+
+void trackedFree(void* pointer, size_t alignment) noexcept {
+    if (pointer && alignment > alignof(std::max_align_t)) {
+        pointer = static_cast<void**>(pointer)[-1];
+    }
+    std::free(pointer);
+}
+
+void* operator new(size_t bytes) {
+    return trackedAllocate(bytes, alignof(std::max_align_t));
+}
+
+void* operator new[](size_t bytes) {
+    return trackedAllocate(bytes, alignof(std::max_align_t));
+}
+
+void* operator new(size_t bytes, std::align_val_t alignment) {
+    return trackedAllocate(bytes, static_cast<size_t>(alignment));
+}
+
+void* operator new[](size_t bytes, std::align_val_t alignment) {
+    return trackedAllocate(bytes, static_cast<size_t>(alignment));
+}
+
+void operator delete(void* pointer) noexcept {
+    trackedFree(pointer, alignof(std::max_align_t));
+}
+
+void operator delete[](void* pointer) noexcept {
+    trackedFree(pointer, alignof(std::max_align_t));
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+    trackedFree(pointer, alignof(std::max_align_t));
+}
+
+void operator delete[](void* pointer, size_t) noexcept {
+    trackedFree(pointer, alignof(std::max_align_t));
+}
+
+void operator delete(void* pointer, std::align_val_t alignment) noexcept {
+    trackedFree(pointer, static_cast<size_t>(alignment));
+}
+
+void operator delete[](void* pointer, std::align_val_t alignment) noexcept {
+    trackedFree(pointer, static_cast<size_t>(alignment));
+}
+
+void operator delete(void* pointer, size_t, std::align_val_t alignment) noexcept {
+    trackedFree(pointer, static_cast<size_t>(alignment));
+}
+
+void operator delete[](void* pointer, size_t, std::align_val_t alignment) noexcept {
+    trackedFree(pointer, static_cast<size_t>(alignment));
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,292 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+#include "glm/glm.hpp"
+#include "color.h"
+#include "framebuffer.h"
+#include "noise.h"
+#include "parallel.h"
+
+// Capa de fondo: una imagen a resolución interna, con la profundidad de
+// blank, que clearFramebuffer() copia tal cual. Solo se vuelve a generar
+// cuando cambia la resolución o, con el skybox, la cámara.
+constexpr int BACKGROUND_STAR_COUNT = 1000;
+constexpr int SKYBOX_FACE_SIZE = 512;
+constexpr int SKYBOX_MIN_MIP_SIZE = 8;
+constexpr int SKYBOX_STAR_COUNT = 6000;
+
+// Seis caras de size x size seguidas: +X, -X, +Y, -Y, +Z, -Z
+struct CubemapLevel {
+    int size = 0;
+    std::vector<Color> texels;
+};
+
+// levels[0] es la resolución completa y cada nivel siguiente la mitad
+struct Cubemap {
+    std::vector<CubemapLevel> levels;
+};
+
+struct BackgroundLayer {
+    bool skyboxEnabled = false;
+    Cubemap skybox; // se hornea al iniciar, con bakeSkybox()
+
+    std::vector<FragColor> image;
+    size_t width = 0;
+    size_t height = 0;
+
+    // Con qué se generó image, para saber si sigue sirviendo
+    bool imageHasSkybox = false;
+    glm::mat4 imageView = glm::mat4(1.0f);
+    glm::mat4 imageProjection = glm::mat4(1.0f);
+};
+
+BackgroundLayer backgroundLayer;
+
+// Estrellas fijas en pantalla (en pixeles de la ventana)
+std::vector<glm::vec2> generateStarPositions() {
+    std::vector<glm::vec2> starPositions;
+
+    for (int i = 0; i < BACKGROUND_STAR_COUNT; ++i) {
+        int x = std::rand() % SCREEN_WIDTH;
+        int y = std::rand() % SCREEN_HEIGHT;
+        starPositions.emplace_back(x, y);
+    }
+
+    return starPositions;
+}
+
+std::vector<glm::vec2> starPositions = generateStarPositions();
+
+// Cara del cubo que ve la dirección y sus coordenadas u, v en [0, 1]
+int cubemapFace(const glm::vec3& direction, float& u, float& v) {
+    float ax = std::abs(direction.x);
+    float ay = std::abs(direction.y);
+    float az = std::abs(direction.z);
+
+    int face;
+    float major, s, t;
+    if (ax >= ay && ax >= az) {
+        face = direction.x > 0.0f ? 0 : 1;
+        major = ax;
+        s = direction.x > 0.0f ? -direction.z : direction.z;
+        t = -direction.y;
+    } else if (ay >= az) {
+        face = direction.y > 0.0f ? 2 : 3;
+        major = ay;
+        s = direction.x;
+        t = direction.y > 0.0f ? direction.z : -direction.z;
+    } else {
+        face = direction.z > 0.0f ? 4 : 5;
+        major = az;
+        s = direction.z > 0.0f ? direction.x : -direction.x;
+        t = -direction.y;
+    }
+
+    u = 0.5f * (s / major + 1.0f);
+    v = 0.5f * (t / major + 1.0f);
+    return face;
+}
+
+// Dirección (sin normalizar) del punto u, v en [0, 1] de una cara; la
+// inversa de cubemapFace()
+glm::vec3 cubemapDirection(int face, float u, float v) {
+    float s = 2.0f * u - 1.0f;
+    float t = 2.0f * v - 1.0f;
+    switch (face) {
+        case 0: return glm::vec3(1.0f, -t, -s);
+        case 1: return glm::vec3(-1.0f, -t, s);
+        case 2: return glm::vec3(s, 1.0f, t);
+        case 3: return glm::vec3(s, -1.0f, -t);
+        case 4: return glm::vec3(s, -t, 1.0f);
+        default: return glm::vec3(-s, -t, -1.0f);
+    }
+}
+
+// Filtro bilineal dentro de la cara; en los bordes se repite el último texel
+Color sampleCubemap(const CubemapLevel& level, const glm::vec3& direction) {
+    float u, v;
+    int face = cubemapFace(direction, u, v);
+
+    int last = level.size - 1;
+    float x = std::clamp(u * level.size - 0.5f, 0.0f, static_cast<float>(last));
+    float y = std::clamp(v * level.size - 0.5f, 0.0f, static_cast<float>(last));
+    int x0 = static_cast<int>(x);
+    int y0 = static_cast<int>(y);
+    int x1 = std::min(x0 + 1, last);
+    int y1 = std::min(y0 + 1, last);
+    float fx = x - x0;
+    float fy = y - y0;
+
+    const Color* texels = level.texels.data() + static_cast<size_t>(face) * level.size * level.size;
+    const Color& c00 = texels[y0 * level.size + x0];
+    const Color& c10 = texels[y0 * level.size + x1];
+    const Color& c01 = texels[y1 * level.size + x0];
+    const Color& c11 = texels[y1 * level.size + x1];
+
+    auto mix = [fx, fy](Uint8 a, Uint8 b, Uint8 c, Uint8 d) {
+        float top = a + (b - a) * fx;
+        float bottom = c + (d - c) * fx;
+        return static_cast<int>(top + (bottom - top) * fy + 0.5f);
+    };
+    return Color(mix(c00.r, c10.r, c01.r, c11.r), mix(c00.g, c10.g, c01.g, c11.g), mix(c00.b, c10.b, c01.b, c11.b));
+}
+
+// Nebulosa tenue: ruido fractal sobre la dirección, con el tono variando
+// entre azul y magenta según otra octava desplazada
+Color nebulaColor(const FastNoiseLite& nebulaNoise, const glm::vec3& direction) {
+    glm::vec3 d = glm::normalize(direction);
+    float density = nebulaNoise.GetNoise(d.x, d.y, d.z);
+    density = std::clamp((density - 0.1f) / 0.6f, 0.0f, 1.0f);
+    density *= density;
+
+    float hue = 0.5f + 0.5f * nebulaNoise.GetNoise(d.x + 17.0f, d.y - 5.0f, d.z + 11.0f);
+    glm::vec3 blue(0.10f, 0.16f, 0.45f);
+    glm::vec3 magenta(0.45f, 0.10f, 0.40f);
+    glm::vec3 color = (blue + (magenta - blue) * hue) * (0.35f * density);
+    return Color(color.x, color.y, color.z);
+}
+
+// Promedio de 2x2 texels del nivel anterior, cara por cara
+CubemapLevel downsampleCubemap(const CubemapLevel& source) {
+    CubemapLevel level;
+    level.size = source.size / 2;
+    level.texels.resize(6 * static_cast<size_t>(level.size) * level.size);
+
+    for (int face = 0; face < 6; ++face) {
+        const Color* from = source.texels.data() + static_cast<size_t>(face) * source.size * source.size;
+        Color* to = level.texels.data() + static_cast<size_t>(face) * level.size * level.size;
+        for (int y = 0; y < level.size; ++y) {
+            for (int x = 0; x < level.size; ++x) {
+                const Color& c00 = from[(2 * y) * source.size + 2 * x];
+                const Color& c10 = from[(2 * y) * source.size + 2 * x + 1];
+                const Color& c01 = from[(2 * y + 1) * source.size + 2 * x];
+                const Color& c11 = from[(2 * y + 1) * source.size + 2 * x + 1];
+                to[y * level.size + x] = Color((c00.r + c10.r + c01.r + c11.r + 2) / 4,
+                                               (c00.g + c10.g + c01.g + c11.g + 2) / 4,
+                                               (c00.b + c10.b + c01.b + c11.b + 2) / 4);
+            }
+        }
+    }
+    return level;
+}
+
+// Nebulosa más un catálogo de estrellas en direcciones uniformes sobre la
+// esfera, con brillo y un tinte leve, y luego la cadena de mipmaps. Se hace
+// una sola vez al iniciar.
+void bakeSkybox(Cubemap& cubemap) {
+    cubemap.levels.assign(1, CubemapLevel{});
+    CubemapLevel& base = cubemap.levels[0];
+    base.size = SKYBOX_FACE_SIZE;
+    base.texels.resize(6 * static_cast<size_t>(SKYBOX_FACE_SIZE) * SKYBOX_FACE_SIZE);
+
+    FastNoiseLite nebulaNoise;
+    nebulaNoise.SetNoiseType(FastNoiseLite::NoiseType_OpenSimplex2);
+    nebulaNoise.SetFractalType(FastNoiseLite::FractalType_FBm);
+    nebulaNoise.SetFractalOctaves(4);
+    nebulaNoise.SetFrequency(1.5f);
+
+    // Cada fila de cada cara es independiente
+    parallelFor(6 * static_cast<size_t>(SKYBOX_FACE_SIZE), [&](size_t row) {
+        int face = static_cast<int>(row / SKYBOX_FACE_SIZE);
+        int y = static_cast<int>(row % SKYBOX_FACE_SIZE);
+        float v = (y + 0.5f) / SKYBOX_FACE_SIZE;
+        for (int x = 0; x < SKYBOX_FACE_SIZE; ++x) {
+            float u = (x + 0.5f) / SKYBOX_FACE_SIZE;
+            base.texels[row * SKYBOX_FACE_SIZE + x] = nebulaColor(nebulaNoise, cubemapDirection(face, u, v));
+        }
+    });
+
+    for (int i = 0; i < SKYBOX_STAR_COUNT; ++i) {
+        float z = 2.0f * std::rand() / RAND_MAX - 1.0f;
+        float angle = 2.0f * 3.14159265f * std::rand() / RAND_MAX;
+        float ring = std::sqrt(std::max(0.0f, 1.0f - z * z));
+        glm::vec3 direction(ring * std::cos(angle), ring * std::sin(angle), z);
+
+        float u, v;
+        int face = cubemapFace(direction, u, v);
+        int x = std::min(static_cast<int>(u * SKYBOX_FACE_SIZE), SKYBOX_FACE_SIZE - 1);
+        int y = std::min(static_cast<int>(v * SKYBOX_FACE_SIZE), SKYBOX_FACE_SIZE - 1);
+
+        float brightness = 0.4f + 0.6f * std::rand() / RAND_MAX;
+        float tint = 0.15f * (2.0f * std::rand() / RAND_MAX - 1.0f);
+        Color& texel = base.texels[(static_cast<size_t>(face) * SKYBOX_FACE_SIZE + y) * SKYBOX_FACE_SIZE + x];
+        texel = texel + Color(brightness * (1.0f + tint), brightness, brightness * (1.0f - tint));
+    }
+
+    while (cubemap.levels.back().size > SKYBOX_MIN_MIP_SIZE) {
+        cubemap.levels.push_back(downsampleCubemap(cubemap.levels.back()));
+    }
+}
+
+void drawStarfield(BackgroundLayer& layer) {
+    layer.image.assign(layer.width * layer.height, blank);
+
+    for (const auto& position : starPositions) {
+        size_t x = static_cast<size_t>(position.x) * layer.width / SCREEN_WIDTH;
+        size_t y = static_cast<size_t>(position.y) * layer.height / SCREEN_HEIGHT;
+        layer.image[y * layer.width + x].color = Color(1.0f, 1.0f, 1.0f);
+    }
+}
+
+// Nivel de mipmap cuyo texel mide lo que un pixel en el centro de la
+// pantalla, para que las estrellas no parpadeen a resoluciones bajas
+size_t skyboxMipLevel(const Cubemap& cubemap, size_t width, const glm::mat4& projection) {
+    float texelsPerPixel = cubemap.levels[0].size / (width * projection[0][0]);
+    size_t level = 0;
+    while (level + 1 < cubemap.levels.size() && texelsPerPixel >= 1.5f) {
+        texelsPerPixel *= 0.5f;
+        ++level;
+    }
+    return level;
+}
+
+// Cada pixel toma la dirección de su rayo con la inversa de la vista (solo
+// la rotación) por la proyección. Los tiles de filas se reparten entre hilos.
+void drawSkybox(BackgroundLayer& layer, const glm::mat4& view, const glm::mat4& projection) {
+    layer.image.resize(layer.width * layer.height);
+
+    const CubemapLevel& level = layer.skybox.levels[skyboxMipLevel(layer.skybox, layer.width, projection)];
+    glm::mat4 inverseViewProjection = glm::inverse(projection * glm::mat4(glm::mat3(view)));
+
+    // El punto en el plano lejano es lineal en las coordenadas normalizadas
+    glm::vec4 stepX = inverseViewProjection[0] * (2.0f / layer.width);
+    glm::vec4 stepY = inverseViewProjection[1] * (2.0f / layer.height);
+    glm::vec4 origin = inverseViewProjection * glm::vec4(-1.0f, -1.0f, 1.0f, 1.0f);
+
+    size_t tileRows = (layer.height + DEPTH_TILE_SIZE - 1) / DEPTH_TILE_SIZE;
+    parallelFor(tileRows, [&](size_t tileRow) {
+        size_t endY = std::min(layer.height, (tileRow + 1) * DEPTH_TILE_SIZE);
+        for (size_t y = tileRow * DEPTH_TILE_SIZE; y < endY; ++y) {
+            glm::vec4 point = origin + stepY * static_cast<float>(y);
+            for (size_t x = 0; x < layer.width; ++x) {
+                glm::vec3 direction = glm::vec3(point) / point.w;
+                layer.image[y * layer.width + x] = FragColor{sampleCubemap(level, direction), blank.z};
+                point += stepX;
+            }
+        }
+    });
+}
+
+// Deja layer.image listo para el cuadro; projection es la proyección sin jitter
+void updateBackground(BackgroundLayer& layer, const glm::mat4& view, const glm::mat4& projection) {
+    bool resized = layer.width != framebufferWidth || layer.height != framebufferHeight;
+    layer.width = framebufferWidth;
+    layer.height = framebufferHeight;
+
+    if (!layer.skyboxEnabled) {
+        if (resized || layer.imageHasSkybox || layer.image.empty()) {
+            drawStarfield(layer);
+            layer.imageHasSkybox = false;
+        }
+        return;
+    }
+
+    if (resized || !layer.imageHasSkybox || view != layer.imageView || projection != layer.imageProjection) {
+        drawSkybox(layer, view, projection);
+        layer.imageHasSkybox = true;
+        layer.imageView = view;
+        layer.imageProjection = projection;
+    }
+}
\ No newline at end of file
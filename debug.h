@@ -0,0 +1,153 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "glm/glm.hpp"
+#include "color.h"
+#include "framebuffer.h"
+#include "line.h"
+#include "lod.h"
+#include "model.h"
+
+// Capa de depuración: aristas de cada triángulo después del vertex shader,
+// esfera envolvente de cada cuerpo y bins de pantalla con fragmentos, con
+// color según el costo (fragmentos generados). Con la capa apagada el
+// pipeline solo revisa enabled una vez por triángulo.
+constexpr size_t DEBUG_BIN_SIZE = 32;
+constexpr float DEBUG_MAX_COST = 4096.0f; // fragmentos para el rojo más intenso
+
+struct DebugTriangle {
+    glm::vec4 a, b, c; // en espacio de clip, para recortar contra el plano cercano
+    uint32_t fragments; // 0 si se descartó en el setup
+};
+
+struct DebugOverlay {
+    bool enabled = false;
+    glm::mat4 viewport = glm::mat4(1.0f); // del framebuffer, en este cuadro
+
+    // Se reutilizan entre cuadros
+    std::vector<DebugTriangle> triangles;
+    std::vector<uint32_t> binFragments;
+    size_t binsWide = 0;
+    size_t binsHigh = 0;
+};
+
+DebugOverlay debugOverlay;
+
+void beginDebugFrame(DebugOverlay& overlay, const glm::mat4& viewport) {
+    overlay.viewport = viewport;
+    overlay.triangles.clear();
+    overlay.binsWide = (framebufferWidth + DEBUG_BIN_SIZE - 1) / DEBUG_BIN_SIZE;
+    overlay.binsHigh = (framebufferHeight + DEBUG_BIN_SIZE - 1) / DEBUG_BIN_SIZE;
+    overlay.binFragments.assign(overlay.binsWide * overlay.binsHigh, 0);
+}
+
+// Devuelve el índice del triángulo para anotarle después sus fragmentos
+size_t recordDebugTriangle(DebugOverlay& overlay, const glm::vec4& a, const glm::vec4& b, const glm::vec4& c) {
+    overlay.triangles.push_back(DebugTriangle{a, b, c, 0});
+    return overlay.triangles.size() - 1;
+}
+
+void countDebugFragment(DebugOverlay& overlay, size_t x, size_t y) {
+    if (x < framebufferWidth && y < framebufferHeight) {
+        ++overlay.binFragments[(y / DEBUG_BIN_SIZE) * overlay.binsWide + x / DEBUG_BIN_SIZE];
+    }
+}
+
+// Gris para lo que no generó fragmentos; de verde a rojo en escala
+// logarítmica para el resto
+Color debugCostColor(uint32_t fragments) {
+    if (fragments == 0)
+        return Color(70, 70, 70);
+
+    float cost = std::clamp(std::log2(static_cast<float>(fragments) + 1.0f) / std::log2(DEBUG_MAX_COST), 0.0f, 1.0f);
+    return Color(std::min(1.0f, 2.0f * cost), std::min(1.0f, 2.0f - 2.0f * cost), 0.1f);
+}
+
+// Se dibuja encima de todo, sin prueba de profundidad, sobre la imagen que
+// se va a presentar: el framebuffer resuelto o, con TAA, la salida a
+// resolución de ventana. pixelAt(i) devuelve el Color& del pixel i de esa
+// imagen; lo anotado a resolución interna se escala a width x height.
+template <typename PixelAt>
+void drawDebugOverlay(const DebugOverlay& overlay, const std::vector<Model>& models,
+                      size_t width, size_t height, PixelAt pixelAt) {
+    if (!overlay.enabled)
+        return;
+
+    glm::vec3 scale(static_cast<float>(width) / framebufferWidth, static_cast<float>(height) / framebufferHeight, 1.0f);
+    glm::mat4 targetViewport = overlay.viewport;
+    for (int column = 0; column < 4; ++column) {
+        targetViewport[column].x *= scale.x;
+        targetViewport[column].y *= scale.y;
+    }
+    LineStyle thin{false, 1.0f};
+    auto plot = [width, height, &pixelAt](const Color& color, float alpha) {
+        return [width, height, &pixelAt, &color, alpha](int x, int y, float, float coverage) {
+            if (x < 0 || y < 0 || x >= static_cast<int>(width) || y >= static_cast<int>(height))
+                return;
+            Color& target = pixelAt(y * width + x);
+            float weight = coverage * alpha;
+            target.r = static_cast<Uint8>(target.r + (color.r - target.r) * weight);
+            target.g = static_cast<Uint8>(target.g + (color.g - target.g) * weight);
+            target.b = static_cast<Uint8>(target.b + (color.b - target.b) * weight);
+        };
+    };
+    auto line = [&thin, width, height, &scale](const glm::vec3& a, const glm::vec3& b, auto& sink) {
+        rasterizeLine(a * scale, b * scale, thin, width, height, sink);
+    };
+
+    // Bins con fragmentos
+    for (size_t by = 0; by < overlay.binsHigh; ++by) {
+        for (size_t bx = 0; bx < overlay.binsWide; ++bx) {
+            uint32_t fragments = overlay.binFragments[by * overlay.binsWide + bx];
+            if (fragments == 0)
+                continue;
+
+            Color color = debugCostColor(fragments);
+            float x0 = static_cast<float>(bx * DEBUG_BIN_SIZE);
+            float y0 = static_cast<float>(by * DEBUG_BIN_SIZE);
+            float x1 = x0 + DEBUG_BIN_SIZE - 1;
+            float y1 = y0 + DEBUG_BIN_SIZE - 1;
+            auto sink = plot(color, 0.5f);
+            line(glm::vec3(x0, y0, 0), glm::vec3(x1, y0, 0), sink);
+            line(glm::vec3(x1, y0, 0), glm::vec3(x1, y1, 0), sink);
+            line(glm::vec3(x1, y1, 0), glm::vec3(x0, y1, 0), sink);
+            line(glm::vec3(x0, y1, 0), glm::vec3(x0, y0, 0), sink);
+        }
+    }
+
+    // Aristas de los triángulos, recortadas contra el plano cercano para no
+    // dibujar reflejado lo que queda detrás de la cámara
+    for (const DebugTriangle& triangle : overlay.triangles) {
+        Color color = debugCostColor(triangle.fragments);
+        auto sink = plot(color, 0.8f);
+        drawLine(triangle.a, triangle.b, targetViewport, thin, width, height, sink);
+        drawLine(triangle.b, triangle.c, targetViewport, thin, width, height, sink);
+        drawLine(triangle.c, triangle.a, targetViewport, thin, width, height, sink);
+    }
+
+    // Contorno de la esfera envolvente de cada cuerpo
+    Color sphereColor(80, 200, 255);
+    auto sphereSink = plot(sphereColor, 1.0f);
+    for (const Model& model : models) {
+        float radius = projectedRadius(model);
+        if (!std::isfinite(radius))
+            continue;
+
+        const Uniform& uniforms = model.uniforms;
+        glm::vec4 clip = uniforms.projection * uniforms.view * uniforms.model * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+        if (clip.w <= 0.0f)
+            continue;
+        glm::vec3 center = glm::vec3(uniforms.viewport * glm::vec4(glm::vec3(clip) / clip.w, 1.0f));
+
+        const int segments = 48;
+        glm::vec3 previous = center + glm::vec3(radius, 0.0f, 0.0f);
+        for (int i = 1; i <= segments; ++i) {
+            float angle = 2.0f * 3.14159265f * i / segments;
+            glm::vec3 current = center + glm::vec3(std::cos(angle), std::sin(angle), 0.0f) * radius;
+            line(previous, current, sphereSink);
+            previous = current;
+        }
+    }
+}
\ No newline at end of file
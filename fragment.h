@@ -9,20 +9,34 @@ struct Vertex {
     glm::vec3 tex;
     glm::vec3 worldPos;
     glm::vec3 originalPos;
+    float invW; // 1 / w en clip space, para interpolar con perspectiva
 };
 
+// Varyings opcionales que declara cada material; el rasterizador solo
+// interpola los que se piden. La normal siempre se interpola porque de ella
+// salen la iluminación y el descarte del lado oscuro.
+constexpr unsigned VARYING_ORIGINAL_POS = 1 << 0;
+constexpr unsigned VARYING_WORLD_POS = 1 << 1;
+
+// Los escalares van primero y juntos; los varyings que el material no pidió
+// quedan sin inicializar.
 struct Fragment {
     uint16_t x;
     uint16_t y;
-    double z;  // zbuffer
-    Color color; // r, g, b values for color
+    float z;  // zbuffer
     float intensity;  // light intensity
-    glm::vec3 worldPos;
+    Color color; // r, g, b values for color
+    // Con MSAA: máscara de muestras cubiertas y pendientes de la profundidad
+    // para evaluarla en cada muestra
+    uint32_t coverage;
+    float dzdx;
+    float dzdy;
     glm::vec3 originalPos;
     glm::vec3 normal;
+    glm::vec3 worldPos;
 };
 
 struct FragColor {
     Color color;
-    double z; // instead of z buffer
+    float z; // instead of z buffer
 };
\ No newline at end of file
@@ -1,87 +1,331 @@
 #pragma once
-#include <array>
+#include <vector>
 #include <algorithm>
+#include <cmath>
 #include "glm/glm.hpp"
 #include <limits>
 #include <mutex>
+#include <cstdio>
 #include <SDL_render.h>
 #include "color.h"  // Include your Color class header
 #include "fragment.h"
+#include "msaa.h"
 
+// Tamaño de la ventana
 constexpr size_t SCREEN_WIDTH = 1000;
 constexpr size_t SCREEN_HEIGHT = 800;
 
+// Resolución interna del framebuffer; puede ser menor que la ventana y al
+// presentar se escala al tamaño de la ventana
+size_t framebufferWidth = SCREEN_WIDTH;
+size_t framebufferHeight = SCREEN_HEIGHT;
+
 FragColor blank{
         Color{0, 0, 0},
-        std::numeric_limits<double>::max()
+        std::numeric_limits<float>::max()
+};
+
+std::vector<FragColor> framebuffer(SCREEN_WIDTH * SCREEN_HEIGHT, blank);
+
+// Create a 2D array of mutexes. Se quedan del tamaño de la ventana: la
+// resolución interna nunca es mayor y así cambiarla no los vuelve a crear.
+std::vector<std::mutex> mutexes(SCREEN_WIDTH * SCREEN_HEIGHT);
+
+// Cuerpo dueño de cada pixel (0 = fondo, i + 1 = models[i]) para reproyectar
+// el cuadro anterior. render() pone en currentBody el cuerpo que dibuja.
+// blendPoint() marca con OVERLAY_BODY lo que mezcla, que no tiene
+// profundidad propia.
+constexpr uint8_t OVERLAY_BODY = 255;
+std::vector<uint8_t> bodyIds(SCREEN_WIDTH * SCREEN_HEIGHT, 0);
+uint8_t currentBody = 0;
+
+// Muestras MSAA, msaaSamples por pixel y seguidas; vacías sin MSAA. La z del
+// framebuffer guarda entonces la muestra más lejana del pixel, que es lo que
+// necesitan el test temprano y el Z jerárquico.
+std::vector<float> sampleDepths;
+std::vector<Color> sampleColors;
+
+void resizeSampleBuffers() {
+    size_t count = msaaSamples > 1 ? framebufferWidth * framebufferHeight * msaaSamples : 0;
+    sampleDepths.assign(count, blank.z);
+    sampleColors.assign(count, blank.color);
+}
+
+void setMsaaSamples(int samples) {
+    msaaSamples = samples;
+    resizeSampleBuffers();
+}
+
+// Z jerárquico: profundidad máxima de cada tile de 8x8 pixeles. Un
+// triángulo o bloque cuya profundidad más cercana está detrás del máximo de
+// un tile no puede pasar el test de profundidad en ningún pixel del tile.
+constexpr size_t DEPTH_TILE_SIZE = 8;
+
+struct DepthTile {
+    float maxZ;
+    bool dirty; // maxZ puede haber bajado; se recalcula al consultarlo
 };
 
-std::array<FragColor, SCREEN_WIDTH * SCREEN_HEIGHT> framebuffer;
+size_t depthTilesWide = (SCREEN_WIDTH + DEPTH_TILE_SIZE - 1) / DEPTH_TILE_SIZE;
+size_t depthTilesHigh = (SCREEN_HEIGHT + DEPTH_TILE_SIZE - 1) / DEPTH_TILE_SIZE;
+std::vector<DepthTile> depthTiles(depthTilesWide * depthTilesHigh, DepthTile{blank.z, false});
+
+void clearDepthTiles() {
+    std::fill(depthTiles.begin(), depthTiles.end(), DepthTile{blank.z, false});
+}
+
+float tileMaxDepth(size_t tileX, size_t tileY) {
+    DepthTile& tile = depthTiles[tileY * depthTilesWide + tileX];
+
+    if (tile.dirty) {
+        size_t endX = std::min(framebufferWidth, (tileX + 1) * DEPTH_TILE_SIZE);
+        size_t endY = std::min(framebufferHeight, (tileY + 1) * DEPTH_TILE_SIZE);
+
+        tile.maxZ = std::numeric_limits<float>::lowest();
+        for (size_t y = tileY * DEPTH_TILE_SIZE; y < endY; ++y) {
+            for (size_t x = tileX * DEPTH_TILE_SIZE; x < endX; ++x) {
+                tile.maxZ = std::max(tile.maxZ, framebuffer[y * framebufferWidth + x].z);
+            }
+        }
+        tile.dirty = false;
+    }
+
+    return tile.maxZ;
+}
+
+// true si nada con profundidad >= nearestZ puede verse en el tile
+bool depthTileOccludes(size_t tileX, size_t tileY, float nearestZ) {
+    return tileMaxDepth(tileX, tileY) <= nearestZ;
+}
+
+// Lo mismo para todos los tiles que toca un rectángulo de pixeles
+bool depthRectOccludes(int minX, int minY, int maxX, int maxY, float nearestZ) {
+    for (size_t tileY = minY / DEPTH_TILE_SIZE; tileY <= maxY / DEPTH_TILE_SIZE; ++tileY) {
+        for (size_t tileX = minX / DEPTH_TILE_SIZE; tileX <= maxX / DEPTH_TILE_SIZE; ++tileX) {
+            if (!depthTileOccludes(tileX, tileY, nearestZ)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void resizeFramebuffer(size_t width, size_t height) {
+    framebufferWidth = width;
+    framebufferHeight = height;
+    framebuffer.assign(width * height, blank);
+    bodyIds.assign(width * height, 0);
+
+    depthTilesWide = (width + DEPTH_TILE_SIZE - 1) / DEPTH_TILE_SIZE;
+    depthTilesHigh = (height + DEPTH_TILE_SIZE - 1) / DEPTH_TILE_SIZE;
+    depthTiles.assign(depthTilesWide * depthTilesHigh, DepthTile{blank.z, false});
+    resizeSampleBuffers();
+}
+
+// Profundidad más cercana que puede tener el fragmento en alguna de sus
+// muestras (las muestras están a menos de medio pixel)
+float nearestSampleDepth(const Fragment& f) {
+    if (msaaSamples == 1)
+        return f.z;
+    return f.z - 0.5f * (std::abs(f.dzdx) + std::abs(f.dzdy));
+}
+
+// Test de profundidad temprano: false si el fragmento ya está tapado y no
+// vale la pena sombrearlo
+bool depthTest(const Fragment& f) {
+    if (f.y >= framebufferHeight || f.x >= framebufferWidth)
+        return false;
+
+    return nearestSampleDepth(f) < framebuffer[f.y * framebufferWidth + f.x].z;
+}
 
-// Create a 2D array of mutexes
-std::array<std::mutex, SCREEN_WIDTH * SCREEN_HEIGHT> mutexes;
+// Escribe el color ya sombreado en cada muestra cubierta que pase el test de
+// profundidad
+void pointSamples(const Fragment& f, size_t index) {
+    const SamplePattern& pattern = samplePattern(msaaSamples);
+    size_t base = index * msaaSamples;
+    float farthest = std::numeric_limits<float>::lowest();
+    bool written = false;
+
+    for (int s = 0; s < pattern.count; ++s) {
+        float& depth = sampleDepths[base + s];
+        if (f.coverage & (1u << s)) {
+            float z = f.z + (f.dzdx * pattern.offsets[s][0] + f.dzdy * pattern.offsets[s][1]) / 16.0f;
+            if (z < depth) {
+                depth = z;
+                sampleColors[base + s] = f.color;
+                written = true;
+            }
+        }
+        farthest = std::max(farthest, depth);
+    }
+
+    if (written) {
+        framebuffer[index].z = farthest;
+        bodyIds[index] = currentBody;
+
+        DepthTile& tile = depthTiles[(f.y / DEPTH_TILE_SIZE) * depthTilesWide + f.x / DEPTH_TILE_SIZE];
+        tile.dirty = true;
+    }
+}
 
 void point(Fragment f) {
-    std::lock_guard<std::mutex> lock(mutexes[f.y * SCREEN_WIDTH + f.x]);
+    if (f.y >= framebufferHeight || f.x >= framebufferWidth)
+        return;
 
-    if (f.y > 0 && f.x > 0 && f.y < SCREEN_HEIGHT && f.x < SCREEN_WIDTH && f.z < framebuffer[f.y * SCREEN_WIDTH + f.x].z) {
-        framebuffer[f.y * SCREEN_WIDTH + f.x] = FragColor{f.color, f.z};
+    std::lock_guard<std::mutex> lock(mutexes[f.y * framebufferWidth + f.x]);
+
+    if (msaaSamples > 1) {
+        pointSamples(f, f.y * framebufferWidth + f.x);
+        return;
+    }
+
+    if (f.z < framebuffer[f.y * framebufferWidth + f.x].z) {
+        framebuffer[f.y * framebufferWidth + f.x] = FragColor{f.color, f.z};
+        bodyIds[f.y * framebufferWidth + f.x] = currentBody;
+
+        DepthTile& tile = depthTiles[(f.y / DEPTH_TILE_SIZE) * depthTilesWide + f.x / DEPTH_TILE_SIZE];
+        tile.dirty = true;
     }
 }
 
-// Función para generar posiciones de estrellas
-std::vector<glm::vec2> generateStarPositions() {
-    std::vector<glm::vec2> starPositions;
+// Mezcla color con el pixel según alpha si z pasa el test de profundidad,
+// sin escribir la profundidad: para líneas y otras capas translúcidas que se
+// dibujan después de los cuerpos. Con MSAA se prueba cada muestra.
+void blendPoint(int x, int y, float z, const Color& color, float alpha) {
+    if (x < 0 || y < 0 || x >= static_cast<int>(framebufferWidth) || y >= static_cast<int>(framebufferHeight))
+        return;
 
-    // Genera un número fijo de estrellas en posiciones aleatorias
-    const int numStars = 1000;
-    for (int i = 0; i < numStars; ++i) {
-        int x = std::rand() % SCREEN_WIDTH;
-        int y = std::rand() % SCREEN_HEIGHT;
-        starPositions.emplace_back(x, y);
+    size_t index = y * framebufferWidth + x;
+    auto blend = [&color, alpha](Color& target) {
+        target.r = static_cast<Uint8>(target.r + (color.r - target.r) * alpha);
+        target.g = static_cast<Uint8>(target.g + (color.g - target.g) * alpha);
+        target.b = static_cast<Uint8>(target.b + (color.b - target.b) * alpha);
+    };
+
+    if (msaaSamples > 1) {
+        for (int s = 0; s < msaaSamples; ++s) {
+            if (z < sampleDepths[index * msaaSamples + s]) {
+                blend(sampleColors[index * msaaSamples + s]);
+                bodyIds[index] = OVERLAY_BODY;
+            }
+        }
+        return;
     }
 
-    return starPositions;
+    if (z < framebuffer[index].z) {
+        blend(framebuffer[index].color);
+        bodyIds[index] = OVERLAY_BODY;
+    }
 }
 
-// Variable global para almacenar las posiciones de las estrellas
-std::vector<glm::vec2> starPositions = generateStarPositions();
+// Copia la capa de fondo (ya a resolución interna y con la profundidad de
+// blank) y limpia los buffers de profundidad, de cuerpos y de muestras
+void clearFramebuffer(const std::vector<FragColor>& background) {
+    std::copy(background.begin(), background.end(), framebuffer.begin());
+    clearDepthTiles();
 
-void clearFramebuffer() {
-    std::fill(framebuffer.begin(), framebuffer.end(), blank);
+    std::fill(bodyIds.begin(), bodyIds.end(), 0);
 
-    // Dibuja estrellas en el framebuffer
-    for (const auto& position : starPositions) {
-        size_t index = static_cast<size_t>(position.y) * SCREEN_WIDTH + static_cast<size_t>(position.x);
-        framebuffer[index].color = Color(1.0f, 1.0f, 1.0f);
+    if (msaaSamples > 1) {
+        std::fill(sampleDepths.begin(), sampleDepths.end(), blank.z);
+        for (size_t i = 0; i < background.size(); ++i) {
+            std::fill_n(sampleColors.begin() + i * msaaSamples, msaaSamples, background[i].color);
+        }
     }
 }
 
-void renderBuffer(SDL_Renderer* renderer) {
-    SDL_Texture* texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, SCREEN_WIDTH, SCREEN_HEIGHT);
+// Con MSAA, promedia las muestras de cada pixel en el framebuffer. Se llama
+// antes de renderBuffer().
+void resolveFramebuffer() {
+    if (msaaSamples == 1)
+        return;
+
+    for (size_t i = 0; i < framebufferWidth * framebufferHeight; ++i) {
+        int r = 0, g = 0, b = 0;
+        for (int s = 0; s < msaaSamples; ++s) {
+            const Color& color = sampleColors[i * msaaSamples + s];
+            r += color.r;
+            g += color.g;
+            b += color.b;
+        }
+        framebuffer[i].color = Color(r / msaaSamples, g / msaaSamples, b / msaaSamples);
+    }
+}
+
+// La textura y el formato se reutilizan entre cuadros; la textura solo se
+// vuelve a crear cuando cambia la resolución interna
+SDL_Texture* framebufferTexture = nullptr;
+size_t framebufferTextureWidth = 0;
+size_t framebufferTextureHeight = 0;
+SDL_PixelFormat* mappingFormat = nullptr;
+
+// Sube una imagen de width x height a la textura y la copia escalada a la
+// ventana. pixelAt(i) devuelve el color del pixel i (filas de abajo hacia
+// arriba, como el framebuffer). SDL_RenderPresent() queda para quien llama,
+// que puede dibujar encima (el HUD).
+template <typename PixelAt>
+void presentBuffer(SDL_Renderer* renderer, size_t width, size_t height, PixelAt pixelAt) {
+    if (!framebufferTexture || framebufferTextureWidth != width || framebufferTextureHeight != height) {
+        if (framebufferTexture) {
+            SDL_DestroyTexture(framebufferTexture);
+        }
+        framebufferTexture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, width, height);
+        SDL_SetTextureBlendMode(framebufferTexture, SDL_BLENDMODE_BLEND);
+        framebufferTextureWidth = width;
+        framebufferTextureHeight = height;
+    }
+
+    if (!mappingFormat) {
+        mappingFormat = SDL_AllocFormat(SDL_PIXELFORMAT_ARGB8888);
+    }
 
     void* texturePixels;
     int pitch;
-    SDL_LockTexture(texture, NULL, &texturePixels, &pitch);
-    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
-
-    Uint32 format = SDL_PIXELFORMAT_ARGB8888;
-    SDL_PixelFormat* mappingFormat = SDL_AllocFormat(format);
+    SDL_LockTexture(framebufferTexture, NULL, &texturePixels, &pitch);
 
     Uint32* texturePixels32 = static_cast<Uint32*>(texturePixels);
-    for (int y = 0; y < SCREEN_HEIGHT; y++) {
-        for (int x = 0; x < SCREEN_WIDTH; x++) {
-            int framebufferY = SCREEN_HEIGHT - y - 1;  // Reverse the order of rows
-            int index = y * (pitch / sizeof(Uint32)) + x;
-            const Color& color = framebuffer[framebufferY * SCREEN_WIDTH + x].color;
+    for (size_t y = 0; y < height; y++) {
+        for (size_t x = 0; x < width; x++) {
+            size_t framebufferY = height - y - 1;  // Reverse the order of rows
+            size_t index = y * (pitch / sizeof(Uint32)) + x;
+            const Color& color = pixelAt(framebufferY * width + x);
             texturePixels32[index] = SDL_MapRGBA(mappingFormat, color.r, color.g, color.b, color.a);
         }
     }
 
-    SDL_UnlockTexture(texture);
+    SDL_UnlockTexture(framebufferTexture);
+    // Se escala a la ventana completa
     SDL_Rect textureRect = {0, 0, SCREEN_WIDTH, SCREEN_HEIGHT};
-    SDL_RenderCopy(renderer, texture, NULL, &textureRect);
-    SDL_DestroyTexture(texture);
+    SDL_RenderCopy(renderer, framebufferTexture, NULL, &textureRect);
+}
+
+// Guarda una imagen de width x height como PPM binario (P6). pixelAt(i)
+// devuelve el color del pixel i, con las filas de abajo hacia arriba como en
+// presentBuffer(); el archivo queda de arriba hacia abajo.
+template <typename PixelAt>
+bool writePPM(const char* path, size_t width, size_t height, PixelAt pixelAt) {
+    FILE* file = std::fopen(path, "wb");
+    if (!file)
+        return false;
+
+    std::fprintf(file, "P6\n%zu %zu\n255\n", width, height);
+    std::vector<unsigned char> row(width * 3);
+    for (size_t y = 0; y < height; ++y) {
+        size_t framebufferY = height - y - 1;
+        for (size_t x = 0; x < width; ++x) {
+            Color color = pixelAt(framebufferY * width + x);
+            row[3 * x] = color.r;
+            row[3 * x + 1] = color.g;
+            row[3 * x + 2] = color.b;
+        }
+        std::fwrite(row.data(), 1, row.size(), file);
+    }
+    return std::fclose(file) == 0;
+}
 
-    SDL_RenderPresent(renderer);
+void renderBuffer(SDL_Renderer* renderer) {
+    presentBuffer(renderer, framebufferWidth, framebufferHeight, [](size_t i) -> const Color& {
+        return framebuffer[i].color;
+    });
 }
\ No newline at end of file
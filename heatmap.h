@@ -0,0 +1,167 @@
+#pragma once
+#include <SDL.h>
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include "color.h"
+#include "fragment.h"
+#include "framebuffer.h"
+
+// Mapa de calor del costo de render(): tiempo de rasterizado y sombreado
+// por tile de 16x16, o fragmentos por pixel (overdraw). Se dibuja sobre la
+// imagen final, fuera de la historia del TAA, y además se acumula para
+// volcar el promedio de toda una corrida a una imagen con --heatmap-out.
+constexpr size_t HEATMAP_TILE_SIZE = 16;
+constexpr float HEATMAP_OPACITY = 0.65f;
+
+enum HeatmapMode {
+    HEATMAP_OFF,
+    HEATMAP_COST,     // ticks del contador de rendimiento por tile
+    HEATMAP_OVERDRAW, // fragmentos rasterizados por pixel
+    HEATMAP_MODE_COUNT
+};
+
+struct Heatmap {
+    HeatmapMode mode = HEATMAP_OFF;
+    const char* dumpPath = nullptr;
+
+    size_t cellSize = 1;
+    size_t cellsWide = 0; // celdas de este cuadro, a resolución interna
+    size_t cellsHigh = 0;
+    std::vector<float> frame;
+
+    // El acumulado usa celdas fijas a resolución de ventana, para que la
+    // resolución dinámica no lo reinicie; solo se reinicia al cambiar de modo
+    size_t totalCellSize = 0;
+    size_t totalWide = 0;
+    size_t totalHigh = 0;
+    std::vector<float> total;
+    size_t frames = 0;
+};
+
+Heatmap heatmap;
+
+void beginHeatmapFrame(Heatmap& map) {
+    size_t cellSize = map.mode == HEATMAP_COST ? HEATMAP_TILE_SIZE : 1;
+    size_t cellsWide = (framebufferWidth + cellSize - 1) / cellSize;
+    size_t cellsHigh = (framebufferHeight + cellSize - 1) / cellSize;
+
+    map.cellSize = cellSize;
+    map.cellsWide = cellsWide;
+    map.cellsHigh = cellsHigh;
+    map.frame.assign(cellsWide * cellsHigh, 0.0f);
+
+    if (cellSize != map.totalCellSize) {
+        map.totalCellSize = cellSize;
+        map.totalWide = (SCREEN_WIDTH + cellSize - 1) / cellSize;
+        map.totalHigh = (SCREEN_HEIGHT + cellSize - 1) / cellSize;
+        map.total.assign(map.totalWide * map.totalHigh, 0.0f);
+        map.frames = 0;
+    }
+}
+
+void addHeatmapCost(Heatmap& map, size_t x, size_t y, float cost) {
+    if (x < framebufferWidth && y < framebufferHeight) {
+        map.frame[(y / map.cellSize) * map.cellsWide + x / map.cellSize] += cost;
+    }
+}
+
+// Después de rasterizar un triángulo: en modo costo, su tiempo se reparte
+// entre los tiles de sus fragmentos; en overdraw, cada fragmento cuenta uno
+void recordHeatmapRaster(Heatmap& map, const Fragment* fragments, size_t count, Uint64 rasterStart) {
+    if (count == 0)
+        return;
+
+    float cost = 1.0f;
+    if (map.mode == HEATMAP_COST) {
+        cost = static_cast<float>(SDL_GetPerformanceCounter() - rasterStart) / count;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        addHeatmapCost(map, fragments[i].x, fragments[i].y, cost);
+    }
+}
+
+// Azul (frío) -> cian -> verde -> amarillo -> rojo (caliente), t en [0, 1]
+Color heatColor(float t) {
+    t = std::clamp(t, 0.0f, 1.0f) * 4.0f;
+    if (t < 1.0f) return Color(0.0f, t, 1.0f);
+    if (t < 2.0f) return Color(0.0f, 1.0f, 2.0f - t);
+    if (t < 3.0f) return Color(t - 2.0f, 1.0f, 0.0f);
+    return Color(1.0f, 4.0f - t, 0.0f);
+}
+
+// Normaliza por el máximo, para que el punto más caro siempre sea rojo
+float heatmapMaximum(const std::vector<float>& values) {
+    float maximum = 0.0f;
+    for (float value : values) {
+        maximum = std::max(maximum, value);
+    }
+    return maximum;
+}
+
+// Suma el cuadro al acumulado. Cada celda de ventana toma la celda interna
+// que cae en su centro; en modo costo se escala por el área, porque un tile
+// interno cubre más ventana cuanto menor es la resolución. El overdraw ya es
+// por pixel y se suma tal cual.
+void accumulateHeatmap(Heatmap& map) {
+    float area = 1.0f;
+    if (map.mode == HEATMAP_COST) {
+        area = static_cast<float>(framebufferWidth * framebufferHeight) / (SCREEN_WIDTH * SCREEN_HEIGHT);
+    }
+
+    for (size_t y = 0; y < map.totalHigh; ++y) {
+        size_t centerY = std::min(y * map.totalCellSize + map.totalCellSize / 2, SCREEN_HEIGHT - 1);
+        size_t cellY = centerY * framebufferHeight / SCREEN_HEIGHT / map.cellSize;
+        for (size_t x = 0; x < map.totalWide; ++x) {
+            size_t centerX = std::min(x * map.totalCellSize + map.totalCellSize / 2, SCREEN_WIDTH - 1);
+            size_t cellX = centerX * framebufferWidth / SCREEN_WIDTH / map.cellSize;
+            map.total[y * map.totalWide + x] += map.frame[cellY * map.cellsWide + cellX] * area;
+        }
+    }
+    ++map.frames;
+}
+
+// Mezcla el mapa del cuadro sobre la imagen que se va a presentar (el
+// framebuffer resuelto o, con TAA, la salida a resolución de ventana; ver
+// drawDebugOverlay()) y lo suma al acumulado. Las celdas sin costo se dejan
+// como están.
+template <typename PixelAt>
+void drawHeatmap(Heatmap& map, size_t width, size_t height, PixelAt pixelAt) {
+    if (map.mode == HEATMAP_OFF)
+        return;
+
+    float maximum = heatmapMaximum(map.frame);
+    if (maximum > 0.0f) {
+        for (size_t y = 0; y < height; ++y) {
+            size_t cellY = y * framebufferHeight / height / map.cellSize;
+            for (size_t x = 0; x < width; ++x) {
+                float value = map.frame[cellY * map.cellsWide + x * framebufferWidth / width / map.cellSize];
+                if (value <= 0.0f)
+                    continue;
+
+                Color heat = heatColor(value / maximum);
+                Color& target = pixelAt(y * width + x);
+                target.r = static_cast<Uint8>(target.r + (heat.r - target.r) * HEATMAP_OPACITY);
+                target.g = static_cast<Uint8>(target.g + (heat.g - target.g) * HEATMAP_OPACITY);
+                target.b = static_cast<Uint8>(target.b + (heat.b - target.b) * HEATMAP_OPACITY);
+            }
+        }
+    }
+
+    accumulateHeatmap(map);
+}
+
+// Promedio acumulado como imagen del tamaño de la ventana, negro donde no
+// hubo costo; false si no hay datos o no se pudo escribir
+bool dumpHeatmap(const Heatmap& map, const char* path) {
+    if (map.frames == 0)
+        return false;
+
+    float maximum = heatmapMaximum(map.total);
+    return writePPM(path, SCREEN_WIDTH, SCREEN_HEIGHT, [&map, maximum](size_t i) {
+        size_t x = i % SCREEN_WIDTH;
+        size_t y = i / SCREEN_WIDTH;
+        float value = map.total[(y / map.totalCellSize) * map.totalWide + x / map.totalCellSize];
+        return value > 0.0f ? heatColor(value / maximum) : Color(0, 0, 0);
+    });
+}
\ No newline at end of file
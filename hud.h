@@ -0,0 +1,171 @@
+#pragma once
+#include <SDL.h>
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include "color.h"
+#include "framebuffer.h"
+#include "stats.h"
+
+// HUD de estadísticas del cuadro: gráfico del tiempo de cada cuadro,
+// percentiles p50/p95/p99 de los últimos HUD_HISTORY cuadros y conteos de
+// triángulos y fragmentos. Se dibuja por software en su propia imagen con
+// una fuente de 3x5 y se copia encima del cuadro ya presentado, así no
+// depende de la resolución interna ni entra en la historia del TAA.
+constexpr size_t HUD_HISTORY = 240; // un cuadro por columna del gráfico
+constexpr int HUD_MARGIN = 8;
+constexpr int HUD_GLYPH_SCALE = 2;
+constexpr int HUD_LINE_HEIGHT = 6 * HUD_GLYPH_SCALE;
+constexpr int HUD_TEXT_LINES = 4;
+constexpr int HUD_GRAPH_HEIGHT = 48;
+constexpr float HUD_GRAPH_MAX_MS = 50.0f; // tope del gráfico
+constexpr int HUD_WIDTH = static_cast<int>(HUD_HISTORY) + 2 * HUD_MARGIN;
+constexpr int HUD_HEIGHT = HUD_TEXT_LINES * HUD_LINE_HEIGHT + HUD_GRAPH_HEIGHT + 3 * HUD_MARGIN;
+
+// Glifos de 3x5 de ' ' a 'Z', fila por fila desde arriba; el bit más alto
+// es el pixel de arriba a la izquierda. Las minúsculas se dibujan como
+// mayúsculas y lo que no está queda en blanco.
+constexpr uint16_t HUD_FONT[] = {
+    0x0000, 0x2482, 0x0000, 0x0000, 0x0000, 0x52A5, 0x0000, 0x0000,
+    0x1491, 0x4494, 0x0000, 0x05D0, 0x0014, 0x01C0, 0x0002, 0x12A4,
+    0x7B6F, 0x2C97, 0x73E7, 0x72CF, 0x5BC9, 0x79CF, 0x79EF, 0x7292,
+    0x7BEF, 0x7BCF, 0x0410, 0x0000, 0x0000, 0x0E38, 0x0000, 0x0000,
+    0x0000, 0x2BED, 0x6BAE, 0x3923, 0x6B6E, 0x79A7, 0x79A4, 0x396B,
+    0x5BED, 0x7497, 0x126A, 0x5BAD, 0x4927, 0x5FED, 0x6B6D, 0x2B6A,
+    0x6BA4, 0x2B73, 0x6BAD, 0x388E, 0x7492, 0x5B6F, 0x5B6A, 0x5BFD,
+    0x5AAD, 0x5A92, 0x72A7,
+};
+
+struct Hud {
+    bool enabled = true;
+
+    std::array<float, HUD_HISTORY> frameMs{}; // circular
+    size_t frames = 0; // total registrados
+    std::array<float, HUD_HISTORY> sorted{}; // para los percentiles, se reutiliza
+
+    std::vector<Uint32> pixels; // HUD_WIDTH x HUD_HEIGHT, de arriba hacia abajo
+    SDL_Texture* texture = nullptr;
+};
+
+Hud hud;
+
+void recordFrameTime(Hud& hud, float ms) {
+    hud.frameMs[hud.frames % HUD_HISTORY] = ms;
+    ++hud.frames;
+}
+
+Uint32 hudColor(const Color& color) {
+    return SDL_MapRGBA(mappingFormat, color.r, color.g, color.b, color.a);
+}
+
+void fillHudRect(Hud& hud, int x, int y, int width, int height, Uint32 color) {
+    int x0 = std::max(x, 0);
+    int y0 = std::max(y, 0);
+    int x1 = std::min(x + width, HUD_WIDTH);
+    int y1 = std::min(y + height, HUD_HEIGHT);
+    for (int py = y0; py < y1; ++py) {
+        std::fill(hud.pixels.begin() + py * HUD_WIDTH + x0, hud.pixels.begin() + py * HUD_WIDTH + x1, color);
+    }
+}
+
+void drawHudText(Hud& hud, int x, int y, const char* text, Uint32 color) {
+    for (; *text; ++text, x += 4 * HUD_GLYPH_SCALE) {
+        int character = std::toupper(static_cast<unsigned char>(*text));
+        if (character < ' ' || character > 'Z')
+            continue;
+
+        uint16_t glyph = HUD_FONT[character - ' '];
+        for (int row = 0; row < 5; ++row) {
+            for (int column = 0; column < 3; ++column) {
+                if (glyph & (1 << (14 - row * 3 - column))) {
+                    fillHudRect(hud, x + column * HUD_GLYPH_SCALE, y + row * HUD_GLYPH_SCALE,
+                                HUD_GLYPH_SCALE, HUD_GLYPH_SCALE, color);
+                }
+            }
+        }
+    }
+}
+
+// Percentil p (0 a 100) de sorted[0, count), ya ordenado
+float hudPercentile(const std::array<float, HUD_HISTORY>& sorted, size_t count, float p) {
+    size_t index = static_cast<size_t>(p / 100.0f * (count - 1) + 0.5f);
+    return sorted[std::min(index, count - 1)];
+}
+
+// Dibuja el HUD sobre lo que ya se copió al renderer, antes de
+// SDL_RenderPresent(). Usa las estadísticas del cuadro actual y los tiempos
+// de los cuadros anteriores.
+void drawHud(SDL_Renderer* renderer, Hud& hud, const FrameStats& stats) {
+    if (!hud.enabled)
+        return;
+
+    if (!hud.texture) {
+        hud.texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, HUD_WIDTH, HUD_HEIGHT);
+        SDL_SetTextureBlendMode(hud.texture, SDL_BLENDMODE_BLEND);
+        hud.pixels.resize(HUD_WIDTH * HUD_HEIGHT);
+    }
+    if (!mappingFormat) {
+        mappingFormat = SDL_AllocFormat(SDL_PIXELFORMAT_ARGB8888);
+    }
+
+    Uint32 background = hudColor(Color(0, 0, 0, 170));
+    Uint32 text = hudColor(Color(230, 230, 230));
+    std::fill(hud.pixels.begin(), hud.pixels.end(), background);
+
+    size_t count = std::min(hud.frames, HUD_HISTORY);
+    char line[64];
+    int y = HUD_MARGIN;
+    if (count > 0) {
+        std::copy(hud.frameMs.begin(), hud.frameMs.begin() + count, hud.sorted.begin());
+        std::sort(hud.sorted.begin(), hud.sorted.begin() + count);
+
+        float last = hud.frameMs[(hud.frames - 1) % HUD_HISTORY];
+        std::snprintf(line, sizeof(line), "%.1f MS  %.0f FPS", last, last > 0.0f ? 1000.0f / last : 0.0f);
+        drawHudText(hud, HUD_MARGIN, y, line, text);
+        y += HUD_LINE_HEIGHT;
+
+        std::snprintf(line, sizeof(line), "P50 %.1f P95 %.1f P99 %.1f",
+                      hudPercentile(hud.sorted, count, 50.0f),
+                      hudPercentile(hud.sorted, count, 95.0f),
+                      hudPercentile(hud.sorted, count, 99.0f));
+        drawHudText(hud, HUD_MARGIN, y, line, text);
+    } else {
+        y += HUD_LINE_HEIGHT;
+    }
+    y += HUD_LINE_HEIGHT;
+
+    std::snprintf(line, sizeof(line), "TRIANGULOS %zu", stats.trianglesRasterized);
+    drawHudText(hud, HUD_MARGIN, y, line, text);
+    y += HUD_LINE_HEIGHT;
+
+    std::snprintf(line, sizeof(line), "FRAGMENTOS %zu DESC %d%%", stats.fragmentsRasterized,
+                  static_cast<int>(earlyRejectionRate(stats) * 100.0f));
+    drawHudText(hud, HUD_MARGIN, y, line, text);
+    y += HUD_LINE_HEIGHT + HUD_MARGIN;
+
+    // Gráfico: una columna por cuadro, el más nuevo a la derecha, con líneas
+    // en 60 y 30 FPS
+    int graphBottom = y + HUD_GRAPH_HEIGHT;
+    auto graphY = [graphBottom](float ms) {
+        return graphBottom - static_cast<int>(std::min(ms, HUD_GRAPH_MAX_MS) / HUD_GRAPH_MAX_MS * HUD_GRAPH_HEIGHT);
+    };
+    Uint32 good = hudColor(Color(80, 200, 90));
+    Uint32 slow = hudColor(Color(230, 190, 60));
+    Uint32 bad = hudColor(Color(230, 70, 60));
+    for (size_t i = 0; i < count; ++i) {
+        float ms = hud.frameMs[(hud.frames - count + i) % HUD_HISTORY];
+        int x = HUD_MARGIN + static_cast<int>(HUD_HISTORY - count + i);
+        int top = graphY(ms);
+        fillHudRect(hud, x, top, 1, graphBottom - top, ms <= 1000.0f / 60.0f ? good : ms <= 1000.0f / 30.0f ? slow : bad);
+    }
+    Uint32 guide = hudColor(Color(255, 255, 255, 90));
+    fillHudRect(hud, HUD_MARGIN, graphY(1000.0f / 60.0f), static_cast<int>(HUD_HISTORY), 1, guide);
+    fillHudRect(hud, HUD_MARGIN, graphY(1000.0f / 30.0f), static_cast<int>(HUD_HISTORY), 1, guide);
+
+    SDL_UpdateTexture(hud.texture, NULL, hud.pixels.data(), HUD_WIDTH * sizeof(Uint32));
+    SDL_Rect rect = {HUD_MARGIN, HUD_MARGIN, HUD_WIDTH, HUD_HEIGHT};
+    SDL_RenderCopy(renderer, hud.texture, NULL, &rect);
+}
\ No newline at end of file
@@ -0,0 +1,177 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include "glm/glm.hpp"
+#include "debug.h"
+#include "heatmap.h"
+#include "fragment.h"
+#include "framebuffer.h"
+#include "lod.h"
+#include "model.h"
+#include "shading.h"
+#include "stats.h"
+#include "trace.h"
+#include "triangle.h"
+
+// Modo impostor: en lugar de rasterizar la icosfera, se recorre el rectángulo
+// que la esfera ocupa en pantalla y por cada pixel se intersecta un rayo con
+// la esfera analítica. Profundidad, normal y originalPos salen exactos.
+template <typename Material>
+void renderImpostor(const Model& model) {
+    TraceScope trace("impostor");
+    const Uniform& uniforms = model.uniforms;
+
+    glm::vec3 center = glm::vec3(uniforms.model * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+    float scale = std::max(
+            glm::length(glm::vec3(uniforms.model[0])),
+            std::max(glm::length(glm::vec3(uniforms.model[1])), glm::length(glm::vec3(uniforms.model[2])))
+    );
+    float radius = sphereLOD.radius * scale;
+
+    glm::mat4 viewProjection = uniforms.projection * uniforms.view;
+    glm::mat4 inverseScreen = glm::inverse(uniforms.viewport * viewProjection);
+    glm::mat4 inverseModel = glm::inverse(uniforms.model);
+    glm::vec3 cameraPosition = glm::vec3(glm::inverse(uniforms.view)[3]);
+
+    // Rectángulo en pantalla: se proyectan las esquinas de la caja que
+    // envuelve a la esfera en espacio de vista.
+    glm::vec3 viewCenter = glm::vec3(uniforms.view * glm::vec4(center, 1.0f));
+    float minX = 0.0f;
+    float minY = 0.0f;
+    float maxX = static_cast<float>(framebufferWidth - 1);
+    float maxY = static_cast<float>(framebufferHeight - 1);
+    // Profundidad del punto de la esfera más cercano a la cámara, para el Z
+    // jerárquico; si la cámara está dentro o muy cerca no se descarta nada
+    float nearestZ = std::numeric_limits<float>::lowest();
+
+    if (-viewCenter.z - radius > 0.0f) {
+        glm::vec4 nearestClip = uniforms.projection * glm::vec4(viewCenter + glm::vec3(0.0f, 0.0f, radius), 1.0f);
+        nearestZ = (uniforms.viewport * glm::vec4(glm::vec3(nearestClip) / nearestClip.w, 1.0f)).z;
+
+        minX = minY = std::numeric_limits<float>::max();
+        maxX = maxY = std::numeric_limits<float>::lowest();
+        for (int corner = 0; corner < 8; ++corner) {
+            glm::vec3 offset(
+                    (corner & 1) ? radius : -radius,
+                    (corner & 2) ? radius : -radius,
+                    (corner & 4) ? radius : -radius
+            );
+            glm::vec4 clip = uniforms.projection * glm::vec4(viewCenter + offset, 1.0f);
+            glm::vec4 screen = uniforms.viewport * glm::vec4(glm::vec3(clip) / clip.w, 1.0f);
+            minX = std::min(minX, screen.x);
+            minY = std::min(minY, screen.y);
+            maxX = std::max(maxX, screen.x);
+            maxY = std::max(maxY, screen.y);
+        }
+    }
+
+    // Con MSAA las muestras llegan hasta medio pixel más allá
+    float pad = msaaSamples > 1 ? 0.5f : 0.0f;
+    int startX = std::max(0, static_cast<int>(std::floor(minX - pad)));
+    int startY = std::max(0, static_cast<int>(std::floor(minY - pad)));
+    int endX = std::min(static_cast<int>(framebufferWidth) - 1, static_cast<int>(std::ceil(maxX + pad)));
+    int endY = std::min(static_cast<int>(framebufferHeight) - 1, static_cast<int>(std::ceil(maxY + pad)));
+    if (startX > endX || startY > endY || depthRectOccludes(startX, startY, endX, endY, nearestZ))
+        return;
+
+    // Distancia a la esfera del rayo que sale de la cámara hacia un punto de
+    // la pantalla, o -1 si no la toca (z = 0.25 es el plano ndc z = 0)
+    glm::vec3 oc = cameraPosition - center;
+    auto intersect = [&](float screenX, float screenY, glm::vec3& direction) {
+        glm::vec4 farPoint = inverseScreen * glm::vec4(screenX, screenY, 0.25f, 1.0f);
+        direction = glm::normalize(glm::vec3(farPoint) / farPoint.w - cameraPosition);
+
+        float b = glm::dot(oc, direction);
+        float c = glm::dot(oc, oc) - radius * radius;
+        float discriminant = b * b - c;
+        if (discriminant < 0.0f)
+            return -1.0f;
+
+        float t = -b - std::sqrt(discriminant);
+        return t < 0.0f ? -1.0f : t;
+    };
+
+    const SamplePattern& pattern = samplePattern(msaaSamples);
+
+    beginShading<Material>();
+    for (int y = startY; y <= endY; ++y) {
+        for (int x = startX; x <= endX; ++x) {
+            if ((x == startX || x % DEPTH_TILE_SIZE == 0) && depthTileOccludes(x / DEPTH_TILE_SIZE, y / DEPTH_TILE_SIZE, nearestZ)) {
+                x = static_cast<int>((x / DEPTH_TILE_SIZE + 1) * DEPTH_TILE_SIZE) - 1;
+                continue;
+            }
+
+            // Aquí el rayo hace de rasterizado, así que el costo del pixel
+            // va desde la intersección hasta escribirlo
+            Uint64 pixelStart = heatmap.mode == HEATMAP_COST ? SDL_GetPerformanceCounter() : 0;
+            glm::vec3 direction;
+            float t = intersect(static_cast<float>(x), static_cast<float>(y), direction);
+
+            // Con MSAA se prueba cada muestra; si el centro no toca la esfera
+            // se sombrea en la primera muestra que sí
+            uint32_t coverage = 1;
+            if (pattern.count > 1) {
+                coverage = 0;
+                for (int s = 0; s < pattern.count; ++s) {
+                    glm::vec3 sampleDirection;
+                    float sampleT = intersect(x + pattern.offsets[s][0] / 16.0f, y + pattern.offsets[s][1] / 16.0f, sampleDirection);
+                    if (sampleT < 0.0f)
+                        continue;
+
+                    coverage |= 1u << s;
+                    if (t < 0.0f) {
+                        t = sampleT;
+                        direction = sampleDirection;
+                    }
+                }
+            }
+
+            if (coverage == 0 || t < 0.0f)
+                continue;
+
+            glm::vec3 worldPos = cameraPosition + direction * t;
+            glm::vec3 normal = (worldPos - center) / radius;
+
+            float intensity = glm::dot(normal, L);
+            if (intensity < 0)
+                continue;
+
+            glm::vec4 clip = viewProjection * glm::vec4(worldPos, 1.0f);
+            glm::vec4 screen = uniforms.viewport * glm::vec4(glm::vec3(clip) / clip.w, 1.0f);
+
+            Fragment fragment;
+            fragment.x = static_cast<uint16_t>(x);
+            fragment.y = static_cast<uint16_t>(y);
+            fragment.z = screen.z;
+            fragment.intensity = intensity;
+            fragment.color = Color(255, 255, 255);
+            fragment.coverage = coverage;
+            fragment.dzdx = 0.0f;
+            fragment.dzdy = 0.0f;
+            fragment.normal = normal;
+            if constexpr ((Material::varyings & VARYING_ORIGINAL_POS) != 0) {
+                fragment.originalPos = glm::vec3(inverseModel * glm::vec4(worldPos, 1.0f));
+            }
+            if constexpr ((Material::varyings & VARYING_WORLD_POS) != 0) {
+                fragment.worldPos = worldPos;
+            }
+
+            ++frameStats.fragmentsRasterized;
+            if (debugOverlay.enabled) {
+                countDebugFragment(debugOverlay, x, y);
+            }
+            if (heatmap.mode == HEATMAP_OVERDRAW) {
+                addHeatmapCost(heatmap, x, y, 1.0f);
+            }
+            if (!depthTest(fragment)) {
+                ++frameStats.fragmentsRejected;
+                continue;
+            }
+
+            point(shadeFragment<Material>(fragment, model));
+            if (heatmap.mode == HEATMAP_COST) {
+                addHeatmapCost(heatmap, x, y, static_cast<float>(SDL_GetPerformanceCounter() - pixelStart));
+            }
+        }
+    }
+}
\ No newline at end of file
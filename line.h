@@ -1,44 +1,133 @@
 #pragma once
-#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <utility>
 #include "glm/glm.hpp"
-#include "fragment.h"
 
-std::vector<Fragment> line(const glm::vec3& v1, const glm::vec3& v2) {
-    glm::ivec2 p1(static_cast<int>(v1.x), static_cast<int>(v1.y));
-    glm::ivec2 p2(static_cast<int>(v2.x), static_cast<int>(v2.y));
+// Rasterizador de líneas sin memoria dinámica. La línea se recorta primero
+// contra el plano cercano y contra el rectángulo de pantalla, así que el
+// costo es proporcional a los pixeles visibles aunque un extremo caiga muy
+// lejos o detrás de la cámara. Cada pixel se entrega a un sink
+// sink(x, y, z, coverage), que decide qué hacer con él (por ejemplo
+// blendPoint() con prueba de profundidad).
+struct LineStyle {
+    bool antialiased = true;
+    float width = 1.0f; // en pixeles
+};
 
-    std::vector<Fragment> fragments;
+// Recorta el segmento en espacio de clip contra el plano cercano (z >= -w);
+// false si queda completamente detrás
+bool clipLineToNearPlane(glm::vec4& a, glm::vec4& b) {
+    float da = a.z + a.w;
+    float db = b.z + b.w;
+    if (da < 0.0f && db < 0.0f)
+        return false;
+    if (da < 0.0f)
+        a = a + (b - a) * (da / (da - db));
+    else if (db < 0.0f)
+        b = b + (a - b) * (db / (db - da));
+    return true;
+}
 
-    int dx = std::abs(p2.x - p1.x);
-    int dy = std::abs(p2.y - p1.y);
-    int sx = (p1.x < p2.x) ? 1 : -1;
-    int sy = (p1.y < p2.y) ? 1 : -1;
+// Liang-Barsky: recorta el segmento de pantalla (z incluida) al rectángulo;
+// false si queda completamente fuera
+bool clipLineToRect(glm::vec3& a, glm::vec3& b, float minX, float minY, float maxX, float maxY) {
+    glm::vec3 delta = b - a;
+    float p[4] = {-delta.x, delta.x, -delta.y, delta.y};
+    float q[4] = {a.x - minX, maxX - a.x, a.y - minY, maxY - a.y};
 
-    int err = dx - dy;
+    float enter = 0.0f;
+    float leave = 1.0f;
+    for (int i = 0; i < 4; ++i) {
+        if (p[i] == 0.0f) {
+            if (q[i] < 0.0f)
+                return false;
+            continue;
+        }
 
-    glm::ivec2 current = p1;
+        float t = q[i] / p[i];
+        if (p[i] < 0.0f)
+            enter = std::max(enter, t);
+        else
+            leave = std::min(leave, t);
+    }
 
-    while (true) {
-        Fragment fragment;
-        fragment.x = current.x;
-        fragment.y = current.y;
+    if (enter > leave)
+        return false;
 
-        fragments.push_back(fragment);
+    glm::vec3 start = a;
+    a = start + delta * enter;
+    b = start + delta * leave;
+    return true;
+}
 
-        if (current == p2) {
-            break;
-        }
+// Línea de ancho style.width entre dos puntos de pantalla dentro de un
+// framebuffer de width x height. Se avanza un pixel por paso en el eje
+// mayor, sin incluir el último para que los segmentos consecutivos no pinten
+// dos veces la unión, y en cada paso se cubren los pixeles del eje menor a
+// menos de medio ancho de la línea. Con antialiasing la cobertura baja en el
+// último pixel de cada borde. La profundidad se interpola linealmente en
+// pantalla, como la z de los triángulos.
+template <typename Sink>
+void rasterizeLine(glm::vec3 a, glm::vec3 b, const LineStyle& style, size_t width, size_t height, Sink&& sink) {
+    float halfWidth = std::max(0.5f, 0.5f * style.width);
 
-        int e2 = 2 * err;
-        if (e2 > -dy) {
-            err -= dy;
-            current.x += sx;
-        }
-        if (e2 < dx) {
-            err += dx;
-            current.y += sy;
+    // Un margen del grosor de la línea para no cortar su borde
+    float margin = halfWidth + 1.0f;
+    if (!clipLineToRect(a, b, -margin, -margin, width + margin, height + margin))
+        return;
+
+    bool steep = std::abs(b.y - a.y) > std::abs(b.x - a.x);
+    if (steep) {
+        std::swap(a.x, a.y);
+        std::swap(b.x, b.y);
+    }
+
+    float length = b.x - a.x;
+    if (length == 0.0f)
+        return;
+
+    float slope = (b.y - a.y) / length;
+    float depthSlope = (b.z - a.z) / length;
+    // Distancia perpendicular a la línea por cada pixel en el eje menor
+    float perpendicular = 1.0f / std::sqrt(1.0f + slope * slope);
+    int reach = static_cast<int>(std::ceil((halfWidth + 0.5f) / perpendicular));
+
+    int step = length > 0.0f ? 1 : -1;
+    int start = static_cast<int>(std::lround(a.x));
+    int end = static_cast<int>(std::lround(b.x));
+
+    for (int major = start; major != end; major += step) {
+        float t = major - a.x;
+        float minor = a.y + slope * t;
+        float z = a.z + depthSlope * t;
+        int center = static_cast<int>(std::lround(minor));
+
+        for (int m = center - reach; m <= center + reach; ++m) {
+            float distance = std::abs(m - minor) * perpendicular;
+            float coverage = style.antialiased
+                             ? std::clamp(halfWidth + 0.5f - distance, 0.0f, 1.0f)
+                             : (distance <= halfWidth ? 1.0f : 0.0f);
+            if (coverage <= 0.0f)
+                continue;
+
+            if (steep)
+                sink(m, major, z, coverage);
+            else
+                sink(major, m, z, coverage);
         }
     }
+}
+
+// Segmento en espacio de clip: recorta contra el plano cercano, divide por w,
+// aplica el viewport y rasteriza
+template <typename Sink>
+void drawLine(glm::vec4 a, glm::vec4 b, const glm::mat4& viewport, const LineStyle& style,
+              size_t width, size_t height, Sink&& sink) {
+    if (!clipLineToNearPlane(a, b))
+        return;
 
-    return fragments;
+    glm::vec4 screenA = viewport * glm::vec4(glm::vec3(a) / a.w, 1.0f);
+    glm::vec4 screenB = viewport * glm::vec4(glm::vec3(b) / b.w, 1.0f);
+    rasterizeLine(glm::vec3(screenA), glm::vec3(screenB), style, width, height, sink);
 }
\ No newline at end of file
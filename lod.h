@@ -0,0 +1,182 @@
+#pragma once
+#include <array>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <utility>
+#include <vector>
+#include "glm/glm.hpp"
+#include "model.h"
+
+// Niveles de detalle para las esferas: icosfera subdividida 0..5 veces
+// (20, 80, 320, 1280, 5120 y 20480 triángulos).
+constexpr int SPHERE_LOD_LEVELS = 6;
+
+// Error máximo permitido en pixeles entre la silueta real y la malla
+constexpr float LOD_MAX_ERROR = 0.5f;
+
+// Para bajar de nivel el error del nivel más grueso debe quedar por debajo de
+// LOD_MAX_ERROR * LOD_HYSTERESIS; así no alterna de nivel cuadro a cuadro.
+constexpr float LOD_HYSTERESIS = 0.6f;
+
+struct SphereLOD {
+    float radius = 1.0f;
+    // Mismo formato que el vertexBufferObject: posición, normal, textura
+    std::array<std::vector<glm::vec3>, SPHERE_LOD_LEVELS> levels;
+    // Ángulo (radianes) que cubre una arista en cada nivel
+    std::array<float, SPHERE_LOD_LEVELS> edgeAngle;
+};
+
+SphereLOD sphereLOD;
+
+int icosphereMidpoint(std::vector<glm::vec3>& points, std::map<std::pair<int, int>, int>& cache, int a, int b) {
+    std::pair<int, int> key = a < b ? std::make_pair(a, b) : std::make_pair(b, a);
+    auto found = cache.find(key);
+    if (found != cache.end()) {
+        return found->second;
+    }
+
+    points.push_back(glm::normalize(points[a] + points[b]));
+    int index = static_cast<int>(points.size()) - 1;
+    cache[key] = index;
+    return index;
+}
+
+std::vector<glm::vec3> generateIcosphere(int subdivisions, float radius, float& edgeAngle) {
+    const float t = (1.0f + std::sqrt(5.0f)) / 2.0f;
+
+    std::vector<glm::vec3> points = {
+            {-1, t, 0}, {1, t, 0}, {-1, -t, 0}, {1, -t, 0},
+            {0, -1, t}, {0, 1, t}, {0, -1, -t}, {0, 1, -t},
+            {t, 0, -1}, {t, 0, 1}, {-t, 0, -1}, {-t, 0, 1}
+    };
+    for (auto& point : points) {
+        point = glm::normalize(point);
+    }
+
+    std::vector<std::array<int, 3>> faces = {
+            {0, 11, 5}, {0, 5, 1}, {0, 1, 7}, {0, 7, 10}, {0, 10, 11},
+            {1, 5, 9}, {5, 11, 4}, {11, 10, 2}, {10, 7, 6}, {7, 1, 8},
+            {3, 9, 4}, {3, 4, 2}, {3, 2, 6}, {3, 6, 8}, {3, 8, 9},
+            {4, 9, 5}, {2, 4, 11}, {6, 2, 10}, {8, 6, 7}, {9, 8, 1}
+    };
+
+    for (int level = 0; level < subdivisions; ++level) {
+        std::map<std::pair<int, int>, int> cache;
+        std::vector<std::array<int, 3>> subdivided;
+        subdivided.reserve(faces.size() * 4);
+
+        for (const auto& face : faces) {
+            int ab = icosphereMidpoint(points, cache, face[0], face[1]);
+            int bc = icosphereMidpoint(points, cache, face[1], face[2]);
+            int ca = icosphereMidpoint(points, cache, face[2], face[0]);
+
+            subdivided.push_back({face[0], ab, ca});
+            subdivided.push_back({face[1], bc, ab});
+            subdivided.push_back({face[2], ca, bc});
+            subdivided.push_back({ab, bc, ca});
+        }
+        faces = std::move(subdivided);
+    }
+
+    // La arista más larga define el error de la silueta
+    edgeAngle = 0.0f;
+    for (const auto& face : faces) {
+        for (int i = 0; i < 3; ++i) {
+            float cosAngle = glm::dot(points[face[i]], points[face[(i + 1) % 3]]);
+            edgeAngle = std::max(edgeAngle, std::acos(std::min(1.0f, cosAngle)));
+        }
+    }
+
+    std::vector<glm::vec3> vertexBufferObject;
+    vertexBufferObject.reserve(faces.size() * 9);
+    for (const auto& face : faces) {
+        for (int index : face) {
+            glm::vec3 direction = points[index];
+            glm::vec3 texture(
+                    0.5f + std::atan2(direction.z, direction.x) / (2.0f * 3.14159265f),
+                    0.5f + std::asin(direction.y) / 3.14159265f,
+                    0.0f
+            );
+
+            vertexBufferObject.push_back(direction * radius);
+            vertexBufferObject.push_back(direction);
+            vertexBufferObject.push_back(texture);
+        }
+    }
+
+    return vertexBufferObject;
+}
+
+// Genera todos los niveles. El radio se toma de la malla cargada para que el
+// ruido de los shaders (que depende de originalPos) conserve su escala.
+void setupSphereLOD(float radius) {
+    sphereLOD.radius = radius;
+    for (int level = 0; level < SPHERE_LOD_LEVELS; ++level) {
+        sphereLOD.levels[level] = generateIcosphere(level, radius, sphereLOD.edgeAngle[level]);
+    }
+}
+
+// Radio promedio de un vertexBufferObject (posición, normal, textura)
+float meshRadius(const std::vector<glm::vec3>& vertexBufferObject) {
+    if (vertexBufferObject.empty()) {
+        return 1.0f;
+    }
+
+    float total = 0.0f;
+    for (size_t i = 0; i < vertexBufferObject.size(); i += 3) {
+        total += glm::length(vertexBufferObject[i]);
+    }
+    return total / static_cast<float>(vertexBufferObject.size() / 3);
+}
+
+// Radio en pixeles de la esfera una vez proyectada; infinito si la cámara
+// está dentro de ella.
+float projectedRadius(const Model& model) {
+    const Uniform& uniforms = model.uniforms;
+    glm::vec3 center = glm::vec3(uniforms.view * uniforms.model * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+    float scale = std::max(
+            glm::length(glm::vec3(uniforms.model[0])),
+            std::max(glm::length(glm::vec3(uniforms.model[1])), glm::length(glm::vec3(uniforms.model[2])))
+    );
+    float radius = sphereLOD.radius * scale;
+    float depth = -center.z;
+
+    if (depth <= radius) {
+        return std::numeric_limits<float>::infinity();
+    }
+
+    // projection[1][1] = 1 / tan(fov / 2), viewport[1][1] = alto / 2
+    return radius * uniforms.projection[1][1] * uniforms.viewport[1][1] / depth;
+}
+
+// Profundidad en espacio de vista del punto de la esfera más cercano a la
+// cámara; negativa si la cámara está dentro.
+float nearestViewDepth(const Model& model) {
+    const Uniform& uniforms = model.uniforms;
+    glm::vec3 center = glm::vec3(uniforms.view * uniforms.model * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+    float scale = std::max(
+            glm::length(glm::vec3(uniforms.model[0])),
+            std::max(glm::length(glm::vec3(uniforms.model[1])), glm::length(glm::vec3(uniforms.model[2])))
+    );
+    return -center.z - sphereLOD.radius * scale;
+}
+
+// Distancia máxima (pixeles) entre la esfera y una cuerda del nivel dado
+float sphereLODError(int level, float radiusInPixels) {
+    return radiusInPixels * (1.0f - std::cos(sphereLOD.edgeAngle[level] * 0.5f));
+}
+
+int selectSphereLOD(float radiusInPixels, int currentLevel) {
+    int level = 0;
+    while (level < SPHERE_LOD_LEVELS - 1 && sphereLODError(level, radiusInPixels) > LOD_MAX_ERROR) {
+        ++level;
+    }
+
+    // Al bajar de detalle solo se cede hasta donde sobra margen
+    while (level < currentLevel && sphereLODError(level, radiusInPixels) > LOD_MAX_ERROR * LOD_HYSTERESIS) {
+        ++level;
+    }
+
+    return level;
+}
\ No newline at end of file
@@ -15,6 +15,21 @@
 #include "ObjLoader.h"
 #include "noise.h"
 #include "model.h"
+#include "materials.h"
+#include "lod.h"
+#include "resolution.h"
+#include "stats.h"
+#include "arena.h"
+#include "temporal.h"
+#include "background.h"
+#include "orbit.h"
+#include "hud.h"
+#include "replay.h"
+#include "golden.h"
+#include "trace.h"
+#include <algorithm>
+#include <cstdlib>
+#include <numeric>
 
 SDL_Window* window = nullptr;
 SDL_Renderer* renderer = nullptr;
@@ -23,7 +38,12 @@ Color currentColor;
 const float MIN_ZOOM = 0.5f;
 const float MAX_ZOOM = 1.0f;
 
+// El título de la ventana se actualiza a lo sumo dos veces por segundo; el
+// HUD muestra el tiempo de cada cuadro
+const Uint32 TITLE_UPDATE_INTERVAL_MS = 500;
+
 std::vector<Model> models;
+RenderMode renderMode = RENDER_MESH;
 
 glm::vec3 cameraPosition(0.0f, 0.0f, 3.0f); // Inicializa la posición de la cámara
 float zoom = 1.0f; // Factor de zoom inicial
@@ -35,19 +55,31 @@ bool init() {
         return false;
     }
 
-    window = SDL_CreateWindow("Celestial Bodies Renderer", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_SHOWN);
+    // Una reproducción corre sin ventana visible
+    Uint32 windowFlags = inputLog.mode == REPLAY_PLAY ? SDL_WINDOW_HIDDEN : SDL_WINDOW_SHOWN;
+    window = SDL_CreateWindow("Celestial Bodies Renderer", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, SCREEN_WIDTH, SCREEN_HEIGHT, windowFlags);
     if (!window) {
         std::cerr << "Error: Failed to create SDL window: " << SDL_GetError() << std::endl;
         return false;
     }
 
+    // Filtro lineal al escalar el framebuffer a la ventana
+    SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "1");
+
+    // Sin aceleración (por ejemplo con SDL_VIDEODRIVER=dummy en una máquina
+    // sin pantalla) se usa el renderer por software
     renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+    if (!renderer) {
+        renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_SOFTWARE);
+    }
     if (!renderer) {
         std::cerr << "Error: Failed to create SDL renderer: " << SDL_GetError() << std::endl;
         return false;
     }
 
     setupNoise();
+    setupMaterials();
+    bakeSkybox(backgroundLayer.skybox);
 
     return true;
 }
@@ -57,71 +89,40 @@ void setColor(const Color& color) {
 }
 
 
-void render() {
-    for (const auto& model : models) {
-        // 1. Vertex Shader
-        std::vector<Vertex> transformedVertices(model.vertices.size() / 3);
-        for (size_t i = 0; i < model.vertices.size() / 3; ++i) {
-            Vertex vertex = {model.vertices[3 * i], model.vertices[3 * i + 1], model.vertices[3 * i + 2]};
-            transformedVertices[i] = vertexShader(vertex, model.uniforms);
-        }
-
-        // 2. Primitive Assembly
-        std::vector<std::vector<Vertex>> assembledVertices(transformedVertices.size() / 3);
-        for (size_t i = 0; i < transformedVertices.size() / 3; ++i) {
-            Vertex edge1 = transformedVertices[3 * i];
-            Vertex edge2 = transformedVertices[3 * i + 1];
-            Vertex edge3 = transformedVertices[3 * i + 2];
-            assembledVertices[i] = {edge1, edge2, edge3};
-        }
+// Ordena los cuerpos de adelante hacia atrás por la profundidad de su punto
+// más cercano. Los cercanos llenan primero el Z buffer y de los lejanos se
+// descartan más fragmentos antes de sombrearlos.
+void sortFrontToBack(std::vector<size_t>& drawOrder) {
+    FrameVector<float> depths(models.size());
+    for (size_t i = 0; i < models.size(); ++i) {
+        depths[i] = nearestViewDepth(models[i]);
+    }
 
-        // 3. Rasterization
-        std::vector<Fragment> fragments;
+    drawOrder.resize(models.size());
+    std::iota(drawOrder.begin(), drawOrder.end(), 0);
+    std::sort(drawOrder.begin(), drawOrder.end(), [&depths](size_t a, size_t b) {
+        return depths[a] < depths[b];
+    });
+}
 
-        for (size_t i = 0; i < assembledVertices.size(); ++i) {
-            std::vector<Fragment> rasterizedTriangle = triangle(
-                    assembledVertices[i][0],
-                    assembledVertices[i][1],
-                    assembledVertices[i][2]
-            );
-            fragments.insert(fragments.end(), rasterizedTriangle.begin(), rasterizedTriangle.end());
-        }
+void render() {
+    TraceScope trace("render");
+    sortFrontToBack(frameStats.drawOrder);
 
-        // 4. Fragment Shader
-        for (size_t i = 0; i < fragments.size(); ++i) {
-            Fragment (*fragmentShader)(Fragment &) = nullptr;
-
-            switch (model.currentShader) {
-                case ROCOSO:
-                    fragmentShader = planetaRocoso;
-                    break;
-                case GASEOSO:
-                    fragmentShader = giganteGaseoso;
-                    break;
-                case ESTRELLA:
-                    fragmentShader = estrella;
-                    break;
-                case LUNA:
-                    fragmentShader = Luna;
-                    break;
-                case VOLCANICO:
-                    fragmentShader = planetaVolcanico;
-                    break;
-                case CRISTAL:
-                    fragmentShader = planetaCristal;
-                    break;
-                case HIELO:
-                    fragmentShader = planetaHielo;
-                    break;
-                default:
-                    std::cerr << "Error: Shader no reconocido." << std::endl;
-                    break;
-            }
-            const Fragment &fragment = fragmentShader(fragments[i]);
+    for (size_t index : frameStats.drawOrder) {
+        const Model& model = models[index];
 
-            point(fragment);
+        // El material se resuelve una vez por modelo, no por fragmento
+        ModelRenderer draw = materialRegistry[model.currentShader][renderMode];
+        if (!draw) {
+            std::cerr << "Error: Shader no reconocido." << std::endl;
+            continue;
         }
+
+        currentBody = static_cast<uint8_t>(index + 1);
+        draw(model);
     }
+    currentBody = 0;
 }
 
 glm::mat4 createViewportMatrix(size_t screenWidth, size_t screenHeight) {
@@ -144,6 +145,63 @@ int SDL_main(int argc, char* argv[]) {
     ShaderType Shader5 = CRISTAL;
     ShaderType Shader6 = HIELO;
 
+    // Opciones de línea de comandos
+    for (int i = 1; i < argc; ++i) {
+        std::string option = argv[i];
+        if (option == "--heatmap" && i + 1 < argc) {
+            // cost u overdraw
+            std::string mode = argv[++i];
+            heatmap.mode = mode == "overdraw" ? HEATMAP_OVERDRAW : HEATMAP_COST;
+        } else if (option == "--heatmap-out" && i + 1 < argc) {
+            // Al salir guarda el promedio del mapa de calor como PPM
+            heatmap.dumpPath = argv[++i];
+            if (heatmap.mode == HEATMAP_OFF) {
+                heatmap.mode = HEATMAP_COST;
+            }
+        } else if (option == "--trace" && i + 1 < argc) {
+            // Traza de Chrome (JSON) de las etapas de un rango de cuadros
+            tracer.path = argv[++i];
+        } else if (option == "--trace-from" && i + 1 < argc) {
+            tracer.firstFrame = std::strtoul(argv[++i], nullptr, 10);
+        } else if (option == "--trace-frames" && i + 1 < argc) {
+            tracer.frameCount = std::strtoul(argv[++i], nullptr, 10);
+        } else if (option == "--record" && i + 1 < argc) {
+            // Graba la entrada y el estado de cada cuadro
+            if (!startRecording(inputLog, argv[++i])) {
+                std::cerr << "Error: no se pudo crear la grabación " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (option == "--replay" && i + 1 < argc) {
+            // Reproduce una grabación sin ventana y termina
+            if (!loadReplay(inputLog, argv[++i])) {
+                std::cerr << "Error: no se pudo leer la grabación " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (option == "--golden" && i + 1 < argc) {
+            // Compara escenas fijas con las imágenes de referencia de la carpeta
+            goldenRun.directory = argv[++i];
+        } else if (option == "--golden-update") {
+            goldenRun.update = true;
+        } else if (option == "--golden-budget" && i + 1 < argc) {
+            // Revisa también los tiempos, con los presupuestos por este factor
+            goldenRun.budgetScale = std::strtof(argv[++i], nullptr);
+        } else {
+            std::cerr << "Opción desconocida: " << option << std::endl;
+        }
+    }
+    if ((goldenRun.update || goldenRun.budgetScale > 0.0f) && !goldenRun.directory) {
+        std::cerr << "Error: --golden-update y --golden-budget necesitan --golden carpeta" << std::endl;
+        return 1;
+    }
+    if (goldenRun.directory) {
+        scriptGoldenRun(inputLog);
+        checkTemporalConvergence(goldenRun);
+    }
+
+    // Las estrellas del skybox y la estrella central usan rand(); con la
+    // misma semilla una reproducción dibuja lo mismo que la grabación
+    std::srand(inputLog.seed);
+
     if (!init()) {
         return 1;
     }
@@ -176,6 +234,11 @@ int SDL_main(int argc, char* argv[]) {
         }
     }
 
+    // Las esferas se dibujan con icosferas generadas con el radio de la malla
+    setupSphereLOD(meshRadius(vertexBufferObject));
+    std::vector<int> lodLevels;
+    std::vector<ShadingCache> shadingCaches;
+
     Uniform uniforms;
 
     glm::mat4 model = glm::mat4(1);
@@ -204,8 +267,9 @@ int SDL_main(int argc, char* argv[]) {
     uniforms.projection = glm::perspective(glm::radians(fovInDegrees), aspectRatio, nearClip, farClip);
 
     // Viewport matrix
-    uniforms.viewport = createViewportMatrix(SCREEN_WIDTH, SCREEN_HEIGHT);
+    uniforms.viewport = createViewportMatrix(framebufferWidth, framebufferHeight);
     Uint32 frameStart, frameTime;
+    Uint64 frameCounterStart;
     std::string title = "FPS: ";
     int speed = 1.0f;
 
@@ -222,11 +286,34 @@ int SDL_main(int argc, char* argv[]) {
     float orbitAngle4 = 0.0f; // Ángulo inicial de órbita para el planeta 4
     float orbitAngle5 = 0.0f; // Ángulo inicial de órbita para el planeta 5
 
+    float orbitRadius1 = 1.5f; // Distancia de cada planeta a la estrella
+    float orbitRadius2 = 2.5f;
+    float orbitRadius3 = 3.3f;
+    float orbitRadius4 = 4.1f;
+    float orbitRadius5 = 5.5f;
+    orbits.resize(5);
+
+
+    Uint32 nextTitleUpdate = 0;
 
     bool running = true;
+    size_t frameNumber = 0;
     while (running) {
+        // Al reproducir, el tiempo de la escena y la resolución son los
+        // grabados y no los que darían el reloj y el tiempo de cada cuadro
+        if (!beginInputFrame(inputLog, sceneTicks)) {
+            break;
+        }
+        if (inputLog.mode == REPLAY_PLAY && setResolutionScale(resolutionController, replayResolutionScale(inputLog))) {
+            uniforms.viewport = createViewportMatrix(framebufferWidth, framebufferHeight);
+        }
         frameStart = SDL_GetTicks();
+        frameCounterStart = SDL_GetPerformanceCounter();
+        resetFrameArena(frameArena);
+        beginTraceFrame(tracer, frameNumber++);
+        TraceScope frameTrace("frame");
 
+        TraceScope sceneTrace("scene");
         models.clear(); // Clear models vector at the beginning of the loop
 
 
@@ -248,7 +335,6 @@ int SDL_main(int argc, char* argv[]) {
 
         Model Estrella;
         Estrella.modelMatrix = glm::mat4(1);
-        Estrella.vertices = vertexBufferObject;
         Estrella.uniforms = uniforms;
         Estrella.currentShader = Shader3;
         models.push_back(Estrella); // Add planeta to models vector
@@ -257,56 +343,59 @@ int SDL_main(int argc, char* argv[]) {
         uniforms.model = translation * rotation1 * scale;
         Model planeta;
         planeta.modelMatrix = glm::mat4(1);
-        planeta.vertices = vertexBufferObject;
         planeta.uniforms = uniforms;
         planeta.currentShader = Shader1;
-        planeta.uniforms.model = glm::translate(planeta.uniforms.model, glm::vec3(1.5f, 0.0f, 0.0f))
+        planeta.uniforms.model = glm::translate(planeta.uniforms.model, glm::vec3(orbitRadius1, 0.0f, 0.0f))
                                  * glm::scale(planeta.uniforms.model, glm::vec3(0.3f, 0.3f, 0.3f));
         models.push_back(planeta);
 
         uniforms.model = translation * rotation2 * scale;
         Model planeta2;
         planeta2.modelMatrix = glm::mat4(1);
-        planeta2.vertices = vertexBufferObject;
         planeta2.uniforms = uniforms;
         planeta2.currentShader = Shader2;
-        planeta2.uniforms.model = glm::translate(planeta2.uniforms.model, glm::vec3(2.5f, 0.0f, 0.0f))
+        planeta2.uniforms.model = glm::translate(planeta2.uniforms.model, glm::vec3(orbitRadius2, 0.0f, 0.0f))
                                   * glm::scale(planeta2.uniforms.model, glm::vec3(0.5f, 0.5f, 0.5f));
         models.push_back(planeta2);
 
         uniforms.model = translation * rotation3 * scale;
         Model planeta3;
         planeta3.modelMatrix = glm::mat4(1);
-        planeta3.vertices = vertexBufferObject;
         planeta3.uniforms = uniforms;
         planeta3.currentShader = Shader4;
-        planeta3.uniforms.model = glm::translate(planeta3.uniforms.model, glm::vec3(3.3f, 0.0f, 0.0f))
+        planeta3.uniforms.model = glm::translate(planeta3.uniforms.model, glm::vec3(orbitRadius3, 0.0f, 0.0f))
                                   * glm::scale(planeta3.uniforms.model, glm::vec3(0.4f, 0.4f, 0.4f));
         models.push_back(planeta3);
 
         uniforms.model = translation * rotation4 * scale;
         Model planeta4;
         planeta4.modelMatrix = glm::mat4(1);
-        planeta4.vertices = vertexBufferObject;
         planeta4.uniforms = uniforms;
         planeta4.currentShader = Shader5;
-        planeta4.uniforms.model = glm::translate(planeta4.uniforms.model, glm::vec3(4.1f, 0.0f, 0.0f))
+        planeta4.uniforms.model = glm::translate(planeta4.uniforms.model, glm::vec3(orbitRadius4, 0.0f, 0.0f))
                                   * glm::scale(planeta4.uniforms.model, glm::vec3(0.75f, 0.75f, 0.75f));
         models.push_back(planeta4);
 
         uniforms.model = translation * rotation5 * scale;
         Model planeta5;
         planeta5.modelMatrix = glm::mat4(1);
-        planeta5.vertices = vertexBufferObject;
         planeta5.uniforms = uniforms;
         planeta5.currentShader = Shader6;
-        planeta5.uniforms.model = glm::translate(planeta5.uniforms.model, glm::vec3(5.5f, 0.0f, 0.0f))
+        planeta5.uniforms.model = glm::translate(planeta5.uniforms.model, glm::vec3(orbitRadius5, 0.0f, 0.0f))
                                   * glm::scale(planeta5.uniforms.model, glm::vec3(0.5f, 0.5f, 0.5f));
         models.push_back(planeta5);
 
+        // Solo se recalculan si cambió alguno de sus parámetros
+        setOrbit(orbits[0], translationVector, rotationAxis, orbitRadius1 * scaleFactor.x);
+        setOrbit(orbits[1], translationVector, rotationAxis, orbitRadius2 * scaleFactor.x);
+        setOrbit(orbits[2], translationVector, rotationAxis, orbitRadius3 * scaleFactor.x);
+        setOrbit(orbits[3], translationVector, rotationAxis, orbitRadius4 * scaleFactor.x);
+        setOrbit(orbits[4], translationVector, rotationAxis, orbitRadius5 * scaleFactor.x);
+        sceneTrace.stop();
 
+        TraceScope eventsTrace("events");
         SDL_Event event;
-        while (SDL_PollEvent(&event)) {
+        while (pollInput(inputLog, event)) {
             if (event.type == SDL_QUIT) {
                 running = false;
             }
@@ -329,6 +418,56 @@ int SDL_main(int argc, char* argv[]) {
                         // Mueve la cámara hacia abajo
                         camera.cameraPosition.y -= 1.0f;
                         break;
+                    case SDLK_i:
+                        // Alterna entre mallas e impostores analíticos
+                        renderMode = renderMode == RENDER_MESH ? RENDER_IMPOSTOR : RENDER_MESH;
+                        break;
+                    case SDLK_r:
+                        // Activa o desactiva la resolución dinámica
+                        resolutionController.enabled = !resolutionController.enabled;
+                        break;
+                    case SDLK_v:
+                        // Activa o desactiva el sombreado de tasa variable
+                        variableRateShadingEnabled = !variableRateShadingEnabled;
+                        break;
+                    case SDLK_m:
+                        // Cambia entre sin MSAA, 2x, 4x y 8x
+                        setMsaaSamples(nextMsaaSamples(msaaSamples));
+                        break;
+                    case SDLK_t:
+                        // Antialiasing temporal: dibuja a media resolución y
+                        // reconstruye la de la ventana
+                        setTemporalEnabled(temporalState, !temporalState.enabled);
+                        resolutionController.maxScale = temporalState.enabled ? TEMPORAL_RENDER_SCALE : 1.0f;
+                        break;
+                    case SDLK_b:
+                        // Alterna entre las estrellas fijas y el skybox
+                        backgroundLayer.skyboxEnabled = !backgroundLayer.skyboxEnabled;
+                        break;
+                    case SDLK_o:
+                        // Muestra u oculta las órbitas
+                        orbitStyle.enabled = !orbitStyle.enabled;
+                        break;
+                    case SDLK_l:
+                        // Antialiasing de las líneas de las órbitas
+                        orbitStyle.line.antialiased = !orbitStyle.line.antialiased;
+                        break;
+                    case SDLK_d:
+                        // Capa de depuración: aristas, esferas envolventes y bins por costo
+                        debugOverlay.enabled = !debugOverlay.enabled;
+                        break;
+                    case SDLK_h:
+                        // Mapa de calor: apagado -> costo por tile -> overdraw
+                        heatmap.mode = static_cast<HeatmapMode>((heatmap.mode + 1) % HEATMAP_MODE_COUNT);
+                        break;
+                    case SDLK_f:
+                        // Muestra u oculta el HUD de tiempos por cuadro
+                        hud.enabled = !hud.enabled;
+                        break;
+                    case SDLK_c:
+                        // Activa o desactiva el cache de sombreado
+                        shadingCacheEnabled = !shadingCacheEnabled;
+                        break;
                     case SDLK_1:
                     case SDLK_2:
                     case SDLK_3:
@@ -378,6 +517,8 @@ int SDL_main(int argc, char* argv[]) {
                 zoom = std::max(MIN_ZOOM, std::min(MAX_ZOOM, zoom));
             }
         }
+        eventsTrace.stop();
+        endInputFrame(inputLog, ReplayFrame{sceneTicks, resolutionController.scale, camera.cameraPosition, camera.targetPosition, zoom});
 
         uniforms.view = glm::lookAt(
                 camera.cameraPosition,
@@ -385,32 +526,148 @@ int SDL_main(int argc, char* argv[]) {
                 camera.upVector
         );
 
-        // Ajusta la matriz de proyección para el zoom
-        uniforms.projection = glm::perspective(glm::radians(fovInDegrees * zoom), aspectRatio, nearClip, farClip);
+        // Ajusta la matriz de proyección para el zoom; en modo temporal se
+        // dibuja con jitter y projection queda sin él para reproyectar
+        projection = glm::perspective(glm::radians(fovInDegrees * zoom), aspectRatio, nearClip, farClip);
+        uniforms.projection = projection;
+        if (temporalState.enabled) {
+            uniforms.projection = jitterProjection(projection, nextTemporalJitter(temporalState), framebufferWidth, framebufferHeight);
+        }
+
+        // Nivel de detalle de cada cuerpo según su tamaño en pantalla y su
+        // cache de sombreado, que persiste entre cuadros
+        TraceScope lodTrace("lod");
+        lodLevels.resize(models.size(), 0);
+        shadingCaches.resize(models.size());
+        for (size_t i = 0; i < models.size(); ++i) {
+            // Los modelos se armaron antes de leer la entrada; usan la cámara
+            // de este cuadro
+            models[i].uniforms.view = uniforms.view;
+            models[i].uniforms.projection = uniforms.projection;
+
+            float radiusInPixels = projectedRadius(models[i]);
+
+            lodLevels[i] = selectSphereLOD(radiusInPixels, lodLevels[i]);
+            models[i].vertices = &sphereLOD.levels[lodLevels[i]];
+
+            prepareShadingCache(shadingCaches[i], radiusInPixels);
+            models[i].shadingCache = &shadingCaches[i];
+        }
+        lodTrace.stop();
 
         SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
         SDL_RenderClear(renderer);
-        clearFramebuffer();
+        {
+            TraceScope trace("background");
+            updateBackground(backgroundLayer, uniforms.view, projection);
+        }
+        {
+            TraceScope trace("clearFramebuffer");
+            clearFramebuffer(backgroundLayer.image);
+        }
+        resetFrameStats();
+        if (debugOverlay.enabled) {
+            beginDebugFrame(debugOverlay, uniforms.viewport);
+        }
+        if (heatmap.mode != HEATMAP_OFF) {
+            beginHeatmapFrame(heatmap);
+        }
 
+#ifdef TRACK_ALLOCATIONS
+        size_t allocationsBefore = heapAllocations.load();
+        render();
+        frameStats.heapAllocations = heapAllocations.load() - allocationsBefore;
+#else
         render();
+#endif
+        {
+            TraceScope trace("orbits");
+            drawOrbits(orbits, uniforms, orbitStyle);
+        }
 
-        renderBuffer(renderer);
+        {
+            TraceScope trace("resolve");
+            resolveFramebuffer();
+        }
+        // El mapa de calor y la capa de depuración van sobre la imagen
+        // final, fuera de la historia del TAA
+        if (temporalState.enabled) {
+            {
+                TraceScope trace("temporal");
+                resolveTemporal(temporalState, models, uniforms, projection, createViewportMatrix(SCREEN_WIDTH, SCREEN_HEIGHT),
+                                backgroundLayer.imageHasSkybox);
+            }
+            std::vector<Color>& image = temporalDisplay(temporalState, heatmap.mode != HEATMAP_OFF || debugOverlay.enabled);
+            auto pixelAt = [&image](size_t i) -> Color& {
+                return image[i];
+            };
+            drawHeatmap(heatmap, SCREEN_WIDTH, SCREEN_HEIGHT, pixelAt);
+            drawDebugOverlay(debugOverlay, models, SCREEN_WIDTH, SCREEN_HEIGHT, pixelAt);
+            TraceScope trace("renderBuffer");
+            renderTemporalBuffer(renderer, image);
+        } else {
+            auto pixelAt = [](size_t i) -> Color& {
+                return framebuffer[i].color;
+            };
+            drawHeatmap(heatmap, framebufferWidth, framebufferHeight, pixelAt);
+            drawDebugOverlay(debugOverlay, models, framebufferWidth, framebufferHeight, pixelAt);
+            TraceScope trace("renderBuffer");
+            renderBuffer(renderer);
+        }
+        {
+            TraceScope trace("hud");
+            drawHud(renderer, hud, frameStats);
+        }
+        {
+            TraceScope trace("present");
+            SDL_RenderPresent(renderer);
+        }
+        endTemporalFrame(temporalState, models, uniforms.view, projection);
 
         frameTime = SDL_GetTicks() - frameStart;
 
+        // Ajusta la resolución interna para el siguiente cuadro
+        float frameMs = static_cast<float>(SDL_GetPerformanceCounter() - frameCounterStart) * 1000.0f / static_cast<float>(SDL_GetPerformanceFrequency());
+        if (inputLog.mode != REPLAY_PLAY && updateResolution(resolutionController, frameMs)) {
+            uniforms.viewport = createViewportMatrix(framebufferWidth, framebufferHeight);
+        }
+        recordFrameTime(hud, frameMs);
+        if (inputLog.mode == REPLAY_PLAY) {
+            inputLog.frameMs.push_back(frameMs);
+        }
+        if (goldenRun.directory) {
+            endGoldenFrame(goldenRun, frameMs);
+        }
+
         // Calculate frames per second and update window title
-        if (frameTime > 0) {
+        if (frameTime > 0 && frameStart >= nextTitleUpdate) {
+            nextTitleUpdate = frameStart + TITLE_UPDATE_INTERVAL_MS;
             std::ostringstream titleStream;
             titleStream << "FPS: " << 1000.0 / frameTime;  // Milliseconds to seconds
+            titleStream << " | Orden:";
+            for (size_t index : frameStats.drawOrder) {
+                titleStream << " " << index + 1;
+            }
+            titleStream << " | Descartados: " << static_cast<int>(earlyRejectionRate(frameStats) * 100.0f) << "%";
+#ifdef TRACK_ALLOCATIONS
+            titleStream << " | Allocs: " << frameStats.heapAllocations;
+#endif
             SDL_SetWindowTitle(window, titleStream.str().c_str());
         }
     }
 
+    finishTrace(tracer);
+    finishInputLog(inputLog);
+
+    if (heatmap.dumpPath && !dumpHeatmap(heatmap, heatmap.dumpPath)) {
+        std::cerr << "Error: no se pudo guardar el mapa de calor en " << heatmap.dumpPath << std::endl;
+    }
+
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
     SDL_Quit();
 
-    return 0;
+    return goldenExitCode(goldenRun);
 }
 
 
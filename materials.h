@@ -0,0 +1,72 @@
+#pragma once
+#include <array>
+#include "fragment.h"
+#include "model.h"
+#include "shaders.h"
+#include "pipeline.h"
+#include "impostor.h"
+#include "shading.h"
+
+// Cada material es un tipo con un shade() estático y sus MaterialTraits. El
+// registro guarda los pipelines ya especializados para ese material,
+// indexados por ShaderType y RenderMode.
+struct RocosoMaterial : MaterialTraits {
+    static Fragment shade(Fragment& fragment) { return planetaRocoso(fragment); }
+};
+
+struct GaseosoMaterial : MaterialTraits {
+    // Nubes de baja frecuencia
+    static constexpr int shadingRate = 2;
+    static Fragment shade(Fragment& fragment) { return giganteGaseoso(fragment); }
+};
+
+struct EstrellaMaterial : MaterialTraits {
+    // Destellos aleatorios distintos en cada cuadro
+    static constexpr bool cacheable = false;
+    static constexpr bool lit = false;
+    // Solo usa rand(), no lee ningún varying
+    static constexpr unsigned varyings = 0;
+    static Fragment shade(Fragment& fragment) { return estrella(fragment); }
+};
+
+struct LunarMaterial : MaterialTraits {
+    static Fragment shade(Fragment& fragment) { return Luna(fragment); }
+};
+
+struct VolcanicoMaterial : MaterialTraits {
+    static constexpr bool lit = false;
+    static Fragment shade(Fragment& fragment) { return planetaVolcanico(fragment); }
+};
+
+struct CristalMaterial : MaterialTraits {
+    // FBm de 6 octavas, el más caro de los planetas
+    static constexpr int shadingRate = 2;
+    static Fragment shade(Fragment& fragment) { return planetaCristal(fragment); }
+};
+
+struct HieloMaterial : MaterialTraits {
+    // Los elementos que se mueven cambian con sceneTicks
+    static constexpr Uint32 refreshMs = 100;
+    static constexpr int shadingRate = 2;
+    static Fragment shade(Fragment& fragment) { return planetaHielo(fragment); }
+};
+
+using ModelRenderer = void (*)(const Model&);
+
+std::array<std::array<ModelRenderer, RENDER_MODE_COUNT>, SHADER_COUNT> materialRegistry{};
+
+template <typename Material>
+void registerMaterial(ShaderType type) {
+    materialRegistry[type][RENDER_MESH] = &renderModel<Material>;
+    materialRegistry[type][RENDER_IMPOSTOR] = &renderImpostor<Material>;
+}
+
+void setupMaterials() {
+    registerMaterial<RocosoMaterial>(ROCOSO);
+    registerMaterial<GaseosoMaterial>(GASEOSO);
+    registerMaterial<EstrellaMaterial>(ESTRELLA);
+    registerMaterial<LunarMaterial>(LUNA);
+    registerMaterial<VolcanicoMaterial>(VOLCANICO);
+    registerMaterial<CristalMaterial>(CRISTAL);
+    registerMaterial<HieloMaterial>(HIELO);
+}
\ No newline at end of file
@@ -1,3 +1,4 @@
+#pragma once
 #include "glm/glm.hpp"
 #include <vector>
 #include "uniform.h"
@@ -9,13 +10,24 @@ enum ShaderType {
     LUNA,
     VOLCANICO,
     CRISTAL,
-    HIELO
+    HIELO,
+    SHADER_COUNT
 };
 
+// Cómo se dibujan los cuerpos: malla rasterizada o impostor analítico
+enum RenderMode {
+    RENDER_MESH,
+    RENDER_IMPOSTOR,
+    RENDER_MODE_COUNT
+};
+
+struct ShadingCache;
+
 class Model {
 public:
     glm::mat4 modelMatrix;
-    std::vector<glm::vec3> vertices;
+    const std::vector<glm::vec3>* vertices = nullptr;
     Uniform uniforms;
     ShaderType currentShader;
+    ShadingCache* shadingCache = nullptr;
 };
\ No newline at end of file
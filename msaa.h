@@ -0,0 +1,35 @@
+#pragma once
+
+// Antialiasing multimuestra: la cobertura y la profundidad se guardan por
+// muestra, pero el shader corre una sola vez por pixel y su color se copia a
+// las muestras cubiertas. Al final del cuadro se promedian las muestras.
+constexpr int MSAA_MAX_SAMPLES = 8;
+
+// Posiciones de las muestras en 1/16 de pixel respecto al punto de muestreo
+// del pixel (los patrones estándar de D3D)
+struct SamplePattern {
+    int count;
+    int offsets[MSAA_MAX_SAMPLES][2];
+};
+
+constexpr SamplePattern SAMPLE_PATTERN_1X = {1, {{0, 0}}};
+constexpr SamplePattern SAMPLE_PATTERN_2X = {2, {{4, 4}, {-4, -4}}};
+constexpr SamplePattern SAMPLE_PATTERN_4X = {4, {{-2, -6}, {6, -2}, {-6, 2}, {2, 6}}};
+constexpr SamplePattern SAMPLE_PATTERN_8X = {8, {{1, -3}, {-1, 3}, {5, 1}, {-3, -5}, {-5, 5}, {-7, -1}, {3, 7}, {7, -7}}};
+
+// Muestras por pixel: 1 (sin MSAA), 2, 4 u 8
+int msaaSamples = 1;
+
+const SamplePattern& samplePattern(int samples) {
+    switch (samples) {
+        case 2: return SAMPLE_PATTERN_2X;
+        case 4: return SAMPLE_PATTERN_4X;
+        case 8: return SAMPLE_PATTERN_8X;
+        default: return SAMPLE_PATTERN_1X;
+    }
+}
+
+// Siguiente modo en el ciclo 1 -> 2 -> 4 -> 8 -> 1
+int nextMsaaSamples(int samples) {
+    return samples >= MSAA_MAX_SAMPLES ? 1 : samples * 2;
+}
\ No newline at end of file
@@ -0,0 +1,78 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "glm/glm.hpp"
+#include "color.h"
+#include "framebuffer.h"
+#include "line.h"
+#include "uniform.h"
+
+// Órbitas de los cuerpos como polilíneas cerradas en el mundo. Los puntos
+// solo se recalculan cuando cambian los parámetros de la órbita; cada cuadro
+// se proyectan y se dibujan como líneas con prueba de profundidad, después
+// de los cuerpos y directo sobre el framebuffer.
+constexpr int ORBIT_SEGMENTS = 128;
+
+struct Orbit {
+    glm::vec3 center = glm::vec3(0.0f);
+    glm::vec3 axis = glm::vec3(0.0f, 0.0f, 1.0f);
+    float radius = 0.0f;
+    std::vector<glm::vec3> points; // ORBIT_SEGMENTS puntos; el último se une con el primero
+};
+
+struct OrbitStyle {
+    bool enabled = true;
+    LineStyle line = LineStyle{true, 1.5f};
+    float opacity = 0.6f;
+    Color color = Color(90, 110, 150);
+};
+
+std::vector<Orbit> orbits;
+OrbitStyle orbitStyle;
+
+// Círculo de radio radius alrededor de axis; el ángulo 0 es la dirección de
+// x proyectada al plano de la órbita, como en glm::rotate
+void setOrbit(Orbit& orbit, const glm::vec3& center, const glm::vec3& axis, float radius) {
+    if (!orbit.points.empty() && orbit.center == center && orbit.axis == axis && orbit.radius == radius)
+        return;
+
+    orbit.center = center;
+    orbit.axis = axis;
+    orbit.radius = radius;
+
+    glm::vec3 normal = glm::normalize(axis);
+    glm::vec3 reference = std::abs(normal.x) < 0.9f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+    glm::vec3 u = glm::normalize(reference - normal * glm::dot(reference, normal));
+    glm::vec3 v = glm::cross(normal, u);
+
+    orbit.points.resize(ORBIT_SEGMENTS);
+    for (int i = 0; i < ORBIT_SEGMENTS; ++i) {
+        float angle = 2.0f * 3.14159265f * i / ORBIT_SEGMENTS;
+        orbit.points[i] = center + (u * std::cos(angle) + v * std::sin(angle)) * radius;
+    }
+}
+
+// Todas las órbitas en una pasada con la misma matriz; cada punto se
+// transforma una vez y se reutiliza en los dos segmentos que lo tocan
+void drawOrbits(const std::vector<Orbit>& orbits, const Uniform& uniforms, const OrbitStyle& style) {
+    if (!style.enabled)
+        return;
+
+    glm::mat4 viewProjection = uniforms.projection * uniforms.view;
+    auto sink = [&style](int x, int y, float z, float coverage) {
+        blendPoint(x, y, z, style.color, coverage * style.opacity);
+    };
+
+    for (const Orbit& orbit : orbits) {
+        if (orbit.points.empty())
+            continue;
+
+        glm::vec4 previous = viewProjection * glm::vec4(orbit.points.back(), 1.0f);
+        for (const glm::vec3& point : orbit.points) {
+            glm::vec4 current = viewProjection * glm::vec4(point, 1.0f);
+            drawLine(previous, current, uniforms.viewport, style.line, framebufferWidth, framebufferHeight, sink);
+            previous = current;
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,104 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "trace.h"
+
+// Hilos de trabajo de parallelFor(). Se crean una vez, la primera vez que
+// hacen falta, y después solo se despiertan; así repartir un trabajo no crea
+// hilos ni pide memoria. La tarea es un puntero a función con su contexto
+// para no guardar una std::function.
+struct WorkerPool {
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable finished;
+
+    void (*task)(void*) = nullptr;
+    void* context = nullptr;
+    size_t generation = 0; // sube con cada tarea
+    size_t busy = 0; // hilos que siguen en la tarea actual
+    bool stopping = false;
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+    }
+};
+
+void workerLoop(WorkerPool& pool) {
+    size_t seen = 0;
+    std::unique_lock<std::mutex> lock(pool.mutex);
+    while (true) {
+        pool.wake.wait(lock, [&pool, &seen]() { return pool.stopping || pool.generation != seen; });
+        if (pool.stopping)
+            return;
+
+        seen = pool.generation;
+        lock.unlock();
+        pool.task(pool.context);
+        lock.lock();
+        if (--pool.busy == 0) {
+            pool.finished.notify_one();
+        }
+    }
+}
+
+WorkerPool& workerPool() {
+    static WorkerPool pool;
+    static std::once_flag started;
+    std::call_once(started, []() {
+        size_t workers = std::max(1u, std::thread::hardware_concurrency()) - 1;
+        for (size_t i = 0; i < workers; ++i) {
+            pool.threads.emplace_back(workerLoop, std::ref(pool));
+        }
+    });
+    return pool;
+}
+
+// Reparte body(0) ... body(count - 1) entre los núcleos disponibles. Cada
+// hilo toma el siguiente índice libre, así que los trabajos pueden tardar
+// distinto; el hilo que llama también trabaja. Los índices no comparten
+// datos de salida, así que no hace falta sincronizar. Con la traza activa,
+// cada hilo anota cuánto estuvo trabajando. Se llama solo desde el hilo
+// principal y no se anida.
+template <typename Body>
+void parallelFor(size_t count, Body body) {
+    std::atomic<size_t> next{0};
+
+    auto work = [&]() {
+        TraceScope trace("parallelFor");
+        for (size_t index = next++; index < count; index = next++) {
+            body(index);
+        }
+    };
+
+    WorkerPool& pool = workerPool();
+    if (count < 2 || pool.threads.empty()) {
+        work();
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        pool.task = [](void* context) { (*static_cast<decltype(work)*>(context))(); };
+        pool.context = &work;
+        pool.busy = pool.threads.size();
+        ++pool.generation;
+    }
+    pool.wake.notify_all();
+    work();
+
+    std::unique_lock<std::mutex> lock(pool.mutex);
+    pool.finished.wait(lock, [&pool]() { return pool.busy == 0; });
+}
\ No newline at end of file
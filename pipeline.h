@@ -0,0 +1,105 @@
+#pragma once
+#include <vector>
+#include "glm/glm.hpp"
+#include "arena.h"
+#include "debug.h"
+#include "heatmap.h"
+#include "fragment.h"
+#include "framebuffer.h"
+#include "model.h"
+#include "shaders.h"
+#include "shading.h"
+#include "stats.h"
+#include "trace.h"
+#include "triangle.h"
+
+// Pipeline completo para un modelo. Se instancia una vez por material, así que
+// el shader del material se puede inlinear dentro del ciclo de fragmentos.
+// Los buffers intermedios salen del arena del cuadro.
+template <typename Material>
+void renderModel(const Model& model) {
+    const std::vector<glm::vec3>& vertices = *model.vertices;
+
+    // 1. Vertex Shader
+    TraceScope vertexTrace("vertex");
+    FrameVector<Vertex> transformedVertices(vertices.size() / 3);
+    for (size_t i = 0; i < vertices.size() / 3; ++i) {
+        Vertex vertex{};
+        vertex.position = vertices[3 * i];
+        vertex.normal = vertices[3 * i + 1];
+        vertex.tex = vertices[3 * i + 2];
+        transformedVertices[i] = vertexShader(vertex, model.uniforms);
+    }
+    vertexTrace.stop();
+
+    // 2. Primitive Assembly: setup de cada triángulo en un arreglo plano.
+    // Con la capa de depuración se anotan todos, incluso los descartados.
+    TraceScope setupTrace("setup");
+    FrameVector<TriangleSetup> triangles;
+    FrameVector<size_t> debugTriangles;
+    glm::mat4 viewProjection = model.uniforms.projection * model.uniforms.view;
+    triangles.reserve(transformedVertices.size() / 3);
+    for (size_t i = 0; i < transformedVertices.size() / 3; ++i) {
+        const Vertex& a = transformedVertices[3 * i];
+        const Vertex& b = transformedVertices[3 * i + 1];
+        const Vertex& c = transformedVertices[3 * i + 2];
+
+        TriangleSetup setup;
+        bool visible = setupTriangle<Material::varyings>(a, b, c, setup);
+        if (visible) {
+            triangles.push_back(setup);
+        }
+        if (debugOverlay.enabled) {
+            size_t debugIndex = recordDebugTriangle(debugOverlay, viewProjection * glm::vec4(a.worldPos, 1.0f),
+                                                    viewProjection * glm::vec4(b.worldPos, 1.0f),
+                                                    viewProjection * glm::vec4(c.worldPos, 1.0f));
+            if (visible) {
+                debugTriangles.push_back(debugIndex);
+            }
+        }
+    }
+    setupTrace.stop();
+    frameStats.trianglesRasterized += triangles.size();
+
+    // 3. Rasterization
+    TraceScope rasterTrace("raster");
+    FrameVector<Fragment> fragments;
+
+    for (size_t i = 0; i < triangles.size(); ++i) {
+        size_t firstFragment = fragments.size();
+        Uint64 rasterStart = heatmap.mode == HEATMAP_COST ? SDL_GetPerformanceCounter() : 0;
+        rasterizeTriangle<Material::varyings>(triangles[i], fragments);
+
+        if (heatmap.mode != HEATMAP_OFF) {
+            recordHeatmapRaster(heatmap, fragments.data() + firstFragment, fragments.size() - firstFragment, rasterStart);
+        }
+
+        if (debugOverlay.enabled) {
+            debugOverlay.triangles[debugTriangles[i]].fragments = static_cast<uint32_t>(fragments.size() - firstFragment);
+            for (size_t f = firstFragment; f < fragments.size(); ++f) {
+                countDebugFragment(debugOverlay, fragments[f].x, fragments[f].y);
+            }
+        }
+    }
+    rasterTrace.stop();
+
+    // 4. Fragment Shader, solo para los fragmentos que pasan el test de
+    // profundidad temprano
+    TraceScope shadingTrace("shading");
+    frameStats.fragmentsRasterized += fragments.size();
+    beginShading<Material>();
+    for (size_t i = 0; i < fragments.size(); ++i) {
+        if (!depthTest(fragments[i])) {
+            ++frameStats.fragmentsRejected;
+            continue;
+        }
+
+        Uint64 shadeStart = heatmap.mode == HEATMAP_COST ? SDL_GetPerformanceCounter() : 0;
+        const Fragment& fragment = shadeFragment<Material>(fragments[i], model);
+
+        point(fragment);
+        if (heatmap.mode == HEATMAP_COST) {
+            addHeatmapCost(heatmap, fragment.x, fragment.y, static_cast<float>(SDL_GetPerformanceCounter() - shadeStart));
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,275 @@
+#pragma once
+#include <SDL.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include "glm/glm.hpp"
+
+// Grabación y reproducción de sesiones para medir rendimiento con la misma
+// entrada. Se guardan, por cuadro, los eventos de teclado, rueda y salida
+// con su timestamp, y el estado de la simulación después de aplicarlos:
+// tiempo de la escena, escala de resolución, cámara y zoom. La reproducción
+// entrega esos eventos en lugar de los de SDL, fija el tiempo y la
+// resolución grabados (que en vivo dependen del reloj) y corre sin ventana
+// visible lo más rápido posible. Con la semilla de rand() grabada, el
+// resultado es el mismo cuadro por cuadro.
+//
+// Formato, binario y sin relleno: encabezado (magia, versión, semilla) y por
+// cada cuadro: número de eventos (u16), cada evento (tipo u8, timestamp u32,
+// valor i32) y el estado (ticks u32, escala, cámara, objetivo y zoom en f32).
+constexpr uint32_t REPLAY_MAGIC = 0x50455253; // "SREP"
+constexpr uint32_t REPLAY_VERSION = 1;
+
+enum ReplayMode {
+    REPLAY_OFF,
+    REPLAY_RECORD,
+    REPLAY_PLAY
+};
+
+enum ReplayEventType : uint8_t {
+    REPLAY_KEY_DOWN,
+    REPLAY_KEY_UP,
+    REPLAY_WHEEL,
+    REPLAY_QUIT
+};
+
+struct ReplayEvent {
+    ReplayEventType type;
+    uint32_t timestamp;
+    int32_t value; // tecla o desplazamiento vertical de la rueda
+};
+
+// Estado de la simulación al terminar la entrada del cuadro
+struct ReplayFrame {
+    Uint32 ticks;
+    float resolutionScale;
+    glm::vec3 cameraPosition;
+    glm::vec3 targetPosition;
+    float zoom;
+};
+
+struct InputLog {
+    ReplayMode mode = REPLAY_OFF;
+    uint32_t seed = 1;
+
+    FILE* file = nullptr; // grabación
+    std::vector<ReplayEvent> events; // grabación: los del cuadro; reproducción: todos
+    std::vector<ReplayFrame> frames; // reproducción
+    std::vector<size_t> firstEvent; // reproducción: índice en events, uno más que frames
+    size_t frame = 0;
+    size_t nextEvent = 0;
+    bool diverged = false;
+    bool scripted = false; // armada en memoria; no hay estado grabado que comparar
+
+    std::vector<float> frameMs; // reproducción, para el resumen
+};
+
+InputLog inputLog;
+
+template <typename T>
+void writeReplayValue(FILE* file, const T& value) {
+    std::fwrite(&value, sizeof(T), 1, file);
+}
+
+template <typename T>
+bool readReplayValue(FILE* file, T& value) {
+    return std::fread(&value, sizeof(T), 1, file) == 1;
+}
+
+bool startRecording(InputLog& log, const char* path) {
+    log.file = std::fopen(path, "wb");
+    if (!log.file)
+        return false;
+
+    writeReplayValue(log.file, REPLAY_MAGIC);
+    writeReplayValue(log.file, REPLAY_VERSION);
+    writeReplayValue(log.file, log.seed);
+    log.mode = REPLAY_RECORD;
+    return true;
+}
+
+// Lee toda la grabación a memoria; false si no existe, el encabezado no es
+// válido o no tiene ningún cuadro completo. Si la grabación se cortó (el
+// programa se cerró a la mitad de un cuadro) se queda con los cuadros
+// completos.
+bool loadReplay(InputLog& log, const char* path) {
+    FILE* file = std::fopen(path, "rb");
+    if (!file)
+        return false;
+
+    uint32_t magic = 0, version = 0;
+    bool valid = readReplayValue(file, magic) && magic == REPLAY_MAGIC
+                 && readReplayValue(file, version) && version == REPLAY_VERSION
+                 && readReplayValue(file, log.seed);
+
+    uint16_t count;
+    while (valid && readReplayValue(file, count)) {
+        size_t firstEvent = log.events.size();
+        bool complete = true;
+        for (uint16_t i = 0; i < count && complete; ++i) {
+            ReplayEvent event;
+            complete = readReplayValue(file, event.type) && readReplayValue(file, event.timestamp)
+                       && readReplayValue(file, event.value);
+            log.events.push_back(event);
+        }
+
+        ReplayFrame frame;
+        complete = complete && readReplayValue(file, frame.ticks) && readReplayValue(file, frame.resolutionScale)
+                   && readReplayValue(file, frame.cameraPosition) && readReplayValue(file, frame.targetPosition)
+                   && readReplayValue(file, frame.zoom);
+        if (!complete) {
+            log.events.resize(firstEvent);
+            break;
+        }
+        log.firstEvent.push_back(firstEvent);
+        log.frames.push_back(frame);
+    }
+    std::fclose(file);
+
+    if (!valid || log.frames.empty())
+        return false;
+
+    log.firstEvent.push_back(log.events.size());
+    log.mode = REPLAY_PLAY;
+    return true;
+}
+
+// Agrega un cuadro a una reproducción armada en memoria, por ejemplo las
+// escenas fijas de --golden: teclas presionadas al empezar el cuadro, tiempo
+// de la escena y escala de resolución
+void scriptReplayFrame(InputLog& log, Uint32 ticks, float resolutionScale, const SDL_Keycode* keys, size_t keyCount) {
+    if (log.firstEvent.empty()) {
+        log.firstEvent.push_back(0);
+    }
+    for (size_t i = 0; i < keyCount; ++i) {
+        log.events.push_back(ReplayEvent{REPLAY_KEY_DOWN, ticks, keys[i]});
+    }
+    log.frames.push_back(ReplayFrame{ticks, resolutionScale, glm::vec3(0.0f), glm::vec3(0.0f), 0.0f});
+    log.firstEvent.push_back(log.events.size());
+    log.mode = REPLAY_PLAY;
+    log.scripted = true;
+}
+
+// Al empezar cada cuadro fija sceneTicks; false cuando la reproducción ya
+// no tiene más cuadros
+bool beginInputFrame(InputLog& log, Uint32& ticks) {
+    if (log.mode != REPLAY_PLAY) {
+        ticks = SDL_GetTicks();
+        return true;
+    }
+    if (log.frame >= log.frames.size())
+        return false;
+
+    ticks = log.frames[log.frame].ticks;
+    log.nextEvent = log.firstEvent[log.frame];
+    return true;
+}
+
+// Escala de resolución grabada para el cuadro que se está reproduciendo
+float replayResolutionScale(const InputLog& log) {
+    return log.frames[log.frame].resolutionScale;
+}
+
+// Reemplaza a SDL_PollEvent() en el ciclo principal. Al reproducir, de SDL
+// solo se atiende el cierre de la ventana y el resto sale de la grabación.
+bool pollInput(InputLog& log, SDL_Event& event) {
+    if (log.mode == REPLAY_PLAY) {
+        while (SDL_PollEvent(&event)) {
+            if (event.type == SDL_QUIT)
+                return true;
+        }
+        if (log.nextEvent >= log.firstEvent[log.frame + 1])
+            return false;
+
+        const ReplayEvent& recorded = log.events[log.nextEvent++];
+        event = SDL_Event{};
+        switch (recorded.type) {
+            case REPLAY_KEY_DOWN:
+            case REPLAY_KEY_UP:
+                event.type = recorded.type == REPLAY_KEY_DOWN ? SDL_KEYDOWN : SDL_KEYUP;
+                event.key.timestamp = recorded.timestamp;
+                event.key.keysym.sym = recorded.value;
+                break;
+            case REPLAY_WHEEL:
+                event.type = SDL_MOUSEWHEEL;
+                event.wheel.timestamp = recorded.timestamp;
+                event.wheel.y = recorded.value;
+                break;
+            case REPLAY_QUIT:
+                event.type = SDL_QUIT;
+                break;
+        }
+        return true;
+    }
+
+    if (!SDL_PollEvent(&event))
+        return false;
+
+    if (log.mode == REPLAY_RECORD) {
+        if (event.type == SDL_KEYDOWN || event.type == SDL_KEYUP) {
+            ReplayEventType type = event.type == SDL_KEYDOWN ? REPLAY_KEY_DOWN : REPLAY_KEY_UP;
+            log.events.push_back(ReplayEvent{type, event.key.timestamp, event.key.keysym.sym});
+        } else if (event.type == SDL_MOUSEWHEEL) {
+            log.events.push_back(ReplayEvent{REPLAY_WHEEL, event.wheel.timestamp, event.wheel.y});
+        } else if (event.type == SDL_QUIT) {
+            log.events.push_back(ReplayEvent{REPLAY_QUIT, event.quit.timestamp, 0});
+        }
+    }
+    return true;
+}
+
+// Después de aplicar la entrada del cuadro. Al grabar escribe el cuadro; al
+// reproducir avisa una vez si el estado se separó de lo grabado.
+void endInputFrame(InputLog& log, const ReplayFrame& state) {
+    if (log.mode == REPLAY_RECORD) {
+        writeReplayValue(log.file, static_cast<uint16_t>(log.events.size()));
+        for (const ReplayEvent& event : log.events) {
+            writeReplayValue(log.file, event.type);
+            writeReplayValue(log.file, event.timestamp);
+            writeReplayValue(log.file, event.value);
+        }
+        writeReplayValue(log.file, state.ticks);
+        writeReplayValue(log.file, state.resolutionScale);
+        writeReplayValue(log.file, state.cameraPosition);
+        writeReplayValue(log.file, state.targetPosition);
+        writeReplayValue(log.file, state.zoom);
+        log.events.clear();
+        // Si el programa se cae o lo matan, la grabación llega hasta aquí
+        std::fflush(log.file);
+    } else if (log.mode == REPLAY_PLAY) {
+        const ReplayFrame& recorded = log.frames[log.frame];
+        bool matches = recorded.cameraPosition == state.cameraPosition
+                       && recorded.targetPosition == state.targetPosition
+                       && recorded.zoom == state.zoom;
+        if (!matches && !log.diverged && !log.scripted) {
+            std::fprintf(stderr, "Reproducción: el estado se separó de la grabación en el cuadro %zu\n", log.frame);
+            log.diverged = true;
+        }
+        ++log.frame;
+    }
+}
+
+// Cierra la grabación o imprime el resumen de tiempos de la reproducción
+void finishInputLog(InputLog& log) {
+    if (log.mode == REPLAY_RECORD && log.file) {
+        std::fclose(log.file);
+        log.file = nullptr;
+    }
+    if (log.mode != REPLAY_PLAY || log.frameMs.empty())
+        return;
+
+    std::vector<float> sorted = log.frameMs;
+    std::sort(sorted.begin(), sorted.end());
+    auto percentile = [&sorted](float p) {
+        return sorted[static_cast<size_t>(std::lround(p / 100.0f * (sorted.size() - 1)))];
+    };
+    double total = 0.0;
+    for (float ms : sorted) {
+        total += ms;
+    }
+    std::printf("Reproducción: %zu cuadros en %.1f ms, promedio %.2f ms, p50 %.2f, p95 %.2f, p99 %.2f, máximo %.2f\n",
+                sorted.size(), total, total / sorted.size(),
+                percentile(50.0f), percentile(95.0f), percentile(99.0f), sorted.back());
+}
\ No newline at end of file
@@ -0,0 +1,69 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include "framebuffer.h"
+
+// Escalado dinámico de resolución: mide el tiempo de cada cuadro y baja o
+// sube la resolución interna del framebuffer para acercarse al objetivo.
+struct ResolutionController {
+    bool enabled = true;
+    float targetMs = 16.6f;
+    float minScale = 0.5f;
+    float maxScale = 1.0f;
+    float scale = 1.0f;
+
+    float averageMs = 0.0f; // promedio exponencial del tiempo de cuadro
+    int cooldown = 0; // cuadros a esperar después de un cambio
+};
+
+ResolutionController resolutionController;
+
+// Dimensiones internas para una escala; múltiplos de 8 para que los bloques
+// de 8x8 siempre queden completos
+void scaledResolution(float scale, size_t& width, size_t& height) {
+    width = std::max<size_t>(8, static_cast<size_t>(SCREEN_WIDTH * scale) / 8 * 8);
+    height = std::max<size_t>(8, static_cast<size_t>(SCREEN_HEIGHT * scale) / 8 * 8);
+}
+
+// Fija la escala sin medir nada (por ejemplo la grabada en una
+// reproducción). Devuelve true si la resolución cambió y hay que reconstruir
+// lo que depende del tamaño del framebuffer (por ejemplo la matriz de
+// viewport). Nunca pasa del tamaño de la ventana, que es el de los mutexes
+// del framebuffer.
+bool setResolutionScale(ResolutionController& controller, float scale) {
+    scale = std::min(scale, 1.0f);
+    size_t width, height;
+    scaledResolution(scale, width, height);
+    controller.scale = scale;
+
+    if (width == framebufferWidth && height == framebufferHeight) {
+        return false;
+    }
+
+    resizeFramebuffer(width, height);
+    controller.cooldown = 15;
+    controller.averageMs = 0.0f;
+    return true;
+}
+
+// Igual que setResolutionScale(), con la escala que pide el tiempo del cuadro
+bool updateResolution(ResolutionController& controller, float frameMs) {
+    float wantedScale = controller.enabled ? controller.scale : controller.maxScale;
+
+    if (controller.enabled) {
+        controller.averageMs = controller.averageMs == 0.0f
+                               ? frameMs
+                               : controller.averageMs * 0.9f + frameMs * 0.1f;
+
+        if (controller.cooldown > 0) {
+            --controller.cooldown;
+        } else if (controller.averageMs > controller.targetMs * 1.1f) {
+            // El costo es casi proporcional al número de pixeles
+            wantedScale = controller.scale * std::max(0.8f, std::sqrt(controller.targetMs / controller.averageMs));
+        } else if (controller.averageMs < controller.targetMs * 0.7f) {
+            wantedScale = controller.scale * 1.05f;
+        }
+    }
+
+    return setResolutionScale(controller, std::clamp(wantedScale, controller.minScale, controller.maxScale));
+}
\ No newline at end of file
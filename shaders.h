@@ -28,7 +28,8 @@ Vertex vertexShader(const Vertex& vertex, const Uniform& uniforms) {
             transformedNormal,
             vertex.tex,
             transformedWorldPosition,
-            vertex.position
+            vertex.position,
+            1.0f / clipSpaceVertex.w
     };
 }
 
@@ -271,7 +272,7 @@ Fragment planetaHielo(Fragment& fragment) {
     glm::vec3 finalColor = baseColor * noiseValue;
 
     // Añadir elementos que se mueven utilizando el tiempo
-    float time = SDL_GetTicks() / 1000.0f; // Obtener el tiempo en segundos
+    float time = sceneTicks / 1000.0f; // Obtener el tiempo en segundos
 
     // Generar elementos que se mueven más rápido
     glm::vec3 movingElements = glm::vec3(
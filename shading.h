@@ -0,0 +1,74 @@
+#pragma once
+#include <SDL.h>
+#include "color.h"
+#include "fragment.h"
+#include "model.h"
+#include "shadingcache.h"
+#include "vrs.h"
+
+// Valores por defecto de los materiales; cada material sobreescribe los suyos.
+struct MaterialTraits {
+    // Si el resultado puede guardarse en el cache
+    static constexpr bool cacheable = true;
+    // Cada cuántos milisegundos caduca el cache (0 = nunca), para materiales
+    // que dependen del tiempo
+    static constexpr Uint32 refreshMs = 0;
+    // Si el shader multiplica su color por fragment.intensity
+    static constexpr bool lit = true;
+    // Lado en pixeles del bloque que comparte una sola invocación (1, 2 o 4)
+    static constexpr int shadingRate = 1;
+    // Varyings que lee el shader (VARYING_*)
+    static constexpr unsigned varyings = VARYING_ORIGINAL_POS;
+};
+
+// Color sin iluminar del fragmento, del cache si el material lo permite
+template <typename Material>
+Color shadeAlbedo(const Fragment& fragment, const Model& model) {
+    static_assert(!Material::cacheable || (Material::varyings & VARYING_ORIGINAL_POS) != 0,
+                  "el cache se indexa con originalPos");
+
+    if constexpr (Material::cacheable) {
+        if (shadingCacheEnabled && model.shadingCache && model.shadingCache->size > 0) {
+            return sampleShadingCache<Material>(*model.shadingCache, fragment);
+        }
+    }
+
+    Fragment unlit = fragment;
+    unlit.intensity = 1.0f;
+    return Material::shade(unlit).color;
+}
+
+// Se llama una vez por modelo antes de sombrear sus fragmentos
+template <typename Material>
+void beginShading() {
+    beginShadingRate(Material::shadingRate);
+}
+
+// Etapa de sombreado del pipeline: reutiliza la muestra del bloque o el cache
+// cuando se puede y aplica la iluminación por pixel encima del color sin
+// iluminar.
+template <typename Material>
+Fragment shadeFragment(Fragment& fragment, const Model& model) {
+    if constexpr (Material::shadingRate > 1) {
+        if (shadingRateBuffer.rate > 1) {
+            bool valid;
+            ShadingRateSample* sample = findShadingRateSample(fragment, valid);
+            if (!valid) {
+                *sample = ShadingRateSample{shadeAlbedo<Material>(fragment, model), shadingRateBuffer.stamp, fragment.normal};
+            }
+
+            fragment.color = Material::lit ? sample->albedo * fragment.intensity : sample->albedo;
+            return fragment;
+        }
+    }
+
+    if constexpr (Material::cacheable) {
+        if (shadingCacheEnabled && model.shadingCache && model.shadingCache->size > 0) {
+            Color albedo = sampleShadingCache<Material>(*model.shadingCache, fragment);
+            fragment.color = Material::lit ? albedo * fragment.intensity : albedo;
+            return fragment;
+        }
+    }
+
+    return Material::shade(fragment);
+}
\ No newline at end of file
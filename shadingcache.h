@@ -0,0 +1,121 @@
+#pragma once
+#include <cmath>
+#include <vector>
+#include <SDL.h>
+#include "glm/glm.hpp"
+#include "color.h"
+#include "fragment.h"
+#include "model.h"
+
+// Cache de sombreado en espacio de superficie. Los shaders dependen casi solo
+// de originalPos, que no cambia cuando el planeta rota u orbita, así que el
+// color sin iluminar se guarda en un cubemap por cuerpo indexado por la
+// dirección en espacio de objeto y se reutiliza entre cuadros.
+
+// La resolución de cada cara sigue al tamaño del cuerpo en pantalla, así un
+// texel cubre más o menos un pixel y el cache no crece más de lo necesario.
+constexpr int SHADING_CACHE_MIN_SIZE = 16;
+constexpr int SHADING_CACHE_MAX_SIZE = 1024;
+
+bool shadingCacheEnabled = true;
+
+struct ShadingTexel {
+    Color color;
+    Uint32 stamp; // 0 = vacío
+};
+
+struct ShadingCache {
+    int size = 0; // texels por lado de cada cara
+    Uint32 ticks = 0; // sceneTicks del cuadro actual
+    std::vector<ShadingTexel> texels;
+};
+
+void invalidateShadingCache(ShadingCache& cache) {
+    for (auto& texel : cache.texels) {
+        texel.stamp = 0;
+    }
+}
+
+// Ajusta la resolución al radio proyectado del cuerpo. Crece en cuanto hace
+// falta, pero solo se reduce cuando sobra más de 4 veces para no descartar
+// el cache por cambios pequeños de zoom.
+void prepareShadingCache(ShadingCache& cache, float radiusInPixels) {
+    int wanted = SHADING_CACHE_MIN_SIZE;
+    while (wanted < SHADING_CACHE_MAX_SIZE && wanted < radiusInPixels * 2.0f) {
+        wanted *= 2;
+    }
+
+    if (wanted > cache.size || wanted * 4 < cache.size) {
+        cache.size = wanted;
+        cache.texels.assign(6 * static_cast<size_t>(wanted) * wanted, ShadingTexel{Color(), 0});
+    }
+
+    cache.ticks = sceneTicks;
+}
+
+// Cara del cubemap y coordenadas en [0, 1] de una dirección
+int cubeFace(const glm::vec3& direction, float& s, float& t) {
+    glm::vec3 a = glm::abs(direction);
+    int face;
+    float u, v, major;
+
+    if (a.x >= a.y && a.x >= a.z) {
+        face = direction.x > 0 ? 0 : 1;
+        major = a.x;
+        u = direction.x > 0 ? -direction.z : direction.z;
+        v = direction.y;
+    } else if (a.y >= a.z) {
+        face = direction.y > 0 ? 2 : 3;
+        major = a.y;
+        u = direction.x;
+        v = direction.y > 0 ? -direction.z : direction.z;
+    } else {
+        face = direction.z > 0 ? 4 : 5;
+        major = a.z;
+        u = direction.z > 0 ? direction.x : -direction.x;
+        v = direction.y;
+    }
+
+    s = u / major * 0.5f + 0.5f;
+    t = v / major * 0.5f + 0.5f;
+    return face;
+}
+
+// Dirección (sin normalizar) del centro de un texel
+glm::vec3 cubeTexelDirection(int face, int i, int j, int size) {
+    float u = ((i + 0.5f) / size) * 2.0f - 1.0f;
+    float v = ((j + 0.5f) / size) * 2.0f - 1.0f;
+
+    switch (face) {
+        case 0: return glm::vec3(1.0f, v, -u);
+        case 1: return glm::vec3(-1.0f, v, u);
+        case 2: return glm::vec3(u, 1.0f, -v);
+        case 3: return glm::vec3(u, -1.0f, v);
+        case 4: return glm::vec3(u, v, 1.0f);
+        default: return glm::vec3(-u, v, -1.0f);
+    }
+}
+
+// Color sin iluminar del texel que contiene a originalPos. Si está vacío o
+// caducado se sombrea en el centro del texel, así el resultado no depende de
+// qué pixel llegó primero.
+template <typename Material>
+Color sampleShadingCache(ShadingCache& cache, const Fragment& fragment) {
+    float s, t;
+    int face = cubeFace(fragment.originalPos, s, t);
+    int i = std::min(static_cast<int>(s * cache.size), cache.size - 1);
+    int j = std::min(static_cast<int>(t * cache.size), cache.size - 1);
+
+    ShadingTexel& texel = cache.texels[(static_cast<size_t>(face) * cache.size + j) * cache.size + i];
+    Uint32 stamp = Material::refreshMs ? 1 + cache.ticks / Material::refreshMs : 1;
+
+    if (texel.stamp != stamp) {
+        Fragment probe = fragment;
+        probe.originalPos = glm::normalize(cubeTexelDirection(face, i, j, cache.size)) * glm::length(fragment.originalPos);
+        probe.intensity = 1.0f;
+        texel.color = Material::shade(probe).color;
+        texel.stamp = stamp;
+    }
+
+    return texel.color;
+}
\ No newline at end of file
@@ -0,0 +1,31 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+// Contadores del cuadro actual para ver qué tan bien funcionan el orden de
+// dibujo y el test de profundidad temprano.
+struct FrameStats {
+    size_t trianglesRasterized = 0; // los que pasaron el setup
+    size_t fragmentsRasterized = 0;
+    size_t fragmentsRejected = 0; // descartados antes de sombrear
+    std::vector<size_t> drawOrder; // índices de los cuerpos en el orden dibujado
+    size_t heapAllocations = 0; // llamadas a new dentro de render() (solo con TRACK_ALLOCATIONS)
+};
+
+FrameStats frameStats;
+
+void resetFrameStats() {
+    frameStats.trianglesRasterized = 0;
+    frameStats.fragmentsRasterized = 0;
+    frameStats.fragmentsRejected = 0;
+    frameStats.heapAllocations = 0;
+    frameStats.drawOrder.clear();
+}
+
+// Fracción de fragmentos que no llegaron al shader
+float earlyRejectionRate(const FrameStats& stats) {
+    if (stats.fragmentsRasterized == 0) {
+        return 0.0f;
+    }
+    return static_cast<float>(stats.fragmentsRejected) / static_cast<float>(stats.fragmentsRasterized);
+}
\ No newline at end of file
@@ -0,0 +1,309 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "glm/glm.hpp"
+#include "color.h"
+#include "framebuffer.h"
+#include "model.h"
+
+// Antialiasing temporal con reescalado: cada cuadro se dibuja con la
+// proyección desplazada una fracción de pixel (secuencia de Halton) y a menor
+// resolución, y se mezcla con la historia a resolución de ventana. La
+// historia se reproyecta con el movimiento conocido de cada cuerpo (su matriz
+// de modelo del cuadro anterior) y se limita al rango de colores vecinos para
+// no dejar estelas.
+constexpr float TEMPORAL_RENDER_SCALE = 0.5f;
+constexpr float TEMPORAL_MIN_BLEND = 0.1f; // peso mínimo del cuadro nuevo
+constexpr float TEMPORAL_MAX_BLEND = 0.5f; // peso cuando la muestra cae en el centro del pixel
+constexpr unsigned TEMPORAL_JITTER_PERIOD = 8;
+
+struct TemporalState {
+    bool enabled = false;
+    bool historyValid = false;
+    unsigned frameIndex = 0;
+    glm::vec2 jitter = glm::vec2(0.0f); // en pixeles internos
+
+    // Cámara sin jitter (completa y solo con la rotación, para el skybox) y
+    // matrices de modelo del cuadro anterior, por cuerpo
+    glm::mat4 previousViewProjection = glm::mat4(1.0f);
+    glm::mat4 previousSkyViewProjection = glm::mat4(1.0f);
+    std::vector<glm::mat4> previousModels;
+
+    // A resolución de ventana; output pasa a ser la historia del siguiente y
+    // mientras tanto sirve para presentar con capas de depuración encima
+    std::vector<Color> history;
+    std::vector<Color> output;
+
+    // A resolución interna: rango de colores vecinos y movimiento (en pixeles
+    // de ventana) de cada pixel del cuadro actual
+    std::vector<Color> neighborhoodLow;
+    std::vector<Color> neighborhoodHigh;
+    std::vector<glm::vec2> velocities;
+    std::vector<uint8_t> velocityValid;
+};
+
+TemporalState temporalState;
+
+float halton(unsigned index, unsigned base) {
+    float result = 0.0f;
+    float fraction = 1.0f;
+    while (index > 0) {
+        fraction /= static_cast<float>(base);
+        result += fraction * static_cast<float>(index % base);
+        index /= base;
+    }
+    return result;
+}
+
+// Desplazamiento del cuadro actual en (-0.5, 0.5) pixeles
+glm::vec2 nextTemporalJitter(TemporalState& state) {
+    unsigned index = state.frameIndex % TEMPORAL_JITTER_PERIOD + 1;
+    state.jitter = glm::vec2(halton(index, 2) - 0.5f, halton(index, 3) - 0.5f);
+    ++state.frameIndex;
+    return state.jitter;
+}
+
+// Mueve la imagen jitter pixeles sin cambiar la profundidad
+glm::mat4 jitterProjection(const glm::mat4& projection, const glm::vec2& jitter, size_t width, size_t height) {
+    glm::mat4 jittered = projection;
+    jittered[2][0] -= 2.0f * jitter.x / static_cast<float>(width);
+    jittered[2][1] -= 2.0f * jitter.y / static_cast<float>(height);
+    return jittered;
+}
+
+void setTemporalEnabled(TemporalState& state, bool enabled) {
+    state.enabled = enabled;
+    state.historyValid = false;
+    state.jitter = glm::vec2(0.0f);
+}
+
+glm::vec2 projectPoint(const glm::mat4& matrix, const glm::vec4& point) {
+    glm::vec4 projected = matrix * point;
+    return glm::vec2(projected.x, projected.y) / projected.w;
+}
+
+// Color de la historia con filtro bilineal; false si el punto cae fuera
+bool sampleHistory(const Color* history, float x, float y, Color& color) {
+    if (!(x >= 0.0f && y >= 0.0f && x < SCREEN_WIDTH - 1 && y < SCREEN_HEIGHT - 1))
+        return false;
+
+    int x0 = static_cast<int>(x);
+    int y0 = static_cast<int>(y);
+    float fx = x - x0;
+    float fy = y - y0;
+
+    const Color* row0 = history + y0 * SCREEN_WIDTH + x0;
+    const Color* row1 = row0 + SCREEN_WIDTH;
+
+    // Sin movimiento el punto cae justo en el pixel: no hace falta filtrar
+    if (fx == 0.0f && fy == 0.0f) {
+        color = row0[0];
+        return true;
+    }
+
+    float w00 = (1.0f - fx) * (1.0f - fy);
+    float w10 = fx * (1.0f - fy);
+    float w01 = (1.0f - fx) * fy;
+    float w11 = fx * fy;
+
+    color.r = static_cast<Uint8>(row0[0].r * w00 + row0[1].r * w10 + row1[0].r * w01 + row1[1].r * w11 + 0.5f);
+    color.g = static_cast<Uint8>(row0[0].g * w00 + row0[1].g * w10 + row1[0].g * w01 + row1[1].g * w11 + 0.5f);
+    color.b = static_cast<Uint8>(row0[0].b * w00 + row0[1].b * w10 + row1[0].b * w01 + row1[1].b * w11 + 0.5f);
+    return true;
+}
+
+// Canal de la historia limitado al rango de los vecinos y mezclado con la
+// muestra nueva; weight es el peso de la muestra nueva en 1/256
+Uint8 blendChannel(int current, int history, int low, int high, int weight) {
+    history = std::clamp(history, low, high);
+    return static_cast<Uint8>(history + (((current - history) * weight + 128) >> 8));
+}
+
+// Reconstruye la imagen a resolución de ventana en state.output a partir del
+// framebuffer resuelto del cuadro actual. projection es la proyección sin
+// jitter; uniforms.projection la que se usó para dibujar. skyboxBackground
+// indica si el fondo es el skybox, que gira con la cámara, o las estrellas
+// fijas en pantalla.
+void resolveTemporal(TemporalState& state, const std::vector<Model>& models, const Uniform& uniforms,
+                     const glm::mat4& projection, const glm::mat4& outputViewport, bool skyboxBackground) {
+    size_t outputSize = SCREEN_WIDTH * SCREEN_HEIGHT;
+    if (state.history.size() != outputSize) {
+        state.history.assign(outputSize, Color());
+        state.output.assign(outputSize, Color());
+        state.historyValid = false;
+    }
+
+    // Pixel interno (con su profundidad) -> pixel de ventana, en este cuadro
+    // sin jitter y en el anterior según el cuerpo que lo cubre
+    glm::mat4 inverseScreen = glm::inverse(uniforms.viewport * uniforms.projection * uniforms.view);
+    glm::mat4 currentOutput = outputViewport * projection * uniforms.view * inverseScreen;
+
+    std::vector<glm::mat4>& previous = state.previousModels;
+    glm::mat4 reprojections[256];
+    bool reprojectable[256] = {};
+    for (size_t i = 0; i < models.size() && i + 1 < OVERLAY_BODY; ++i) {
+        if (i < previous.size()) {
+            reprojections[i + 1] = outputViewport * state.previousViewProjection * previous[i]
+                                   * glm::inverse(models[i].uniforms.model) * inverseScreen;
+            reprojectable[i + 1] = true;
+        }
+    }
+
+    // El skybox está en el infinito: se dibuja sin jitter y se reproyecta
+    // solo con la rotación de la cámara, desde su plano lejano
+    glm::mat4 skyView = glm::mat4(glm::mat3(uniforms.view));
+    glm::mat4 inverseSky = glm::inverse(uniforms.viewport * projection * skyView);
+    glm::mat4 skyReprojection = outputViewport * state.previousSkyViewProjection * inverseSky;
+    glm::mat4 skyCurrent = outputViewport * projection * skyView * inverseSky;
+    float skyDepth = (uniforms.viewport * glm::vec4(0.0f, 0.0f, 1.0f, 1.0f)).z;
+
+    // Lo que mezcla blendPoint() (las órbitas) está en el mundo pero sin
+    // profundidad: solo conserva la historia si la cámara no se movió
+    bool overlayStill = state.previousViewProjection == projection * uniforms.view;
+
+    // 1. Por pixel interno: rango de vecinos y movimiento. Se hace una vez
+    // por muestra y no por cada pixel de ventana que la usa.
+    size_t internalSize = framebufferWidth * framebufferHeight;
+    state.neighborhoodLow.resize(internalSize);
+    state.neighborhoodHigh.resize(internalSize);
+    state.velocities.resize(internalSize);
+    state.velocityValid.resize(internalSize);
+
+    int lastX = static_cast<int>(framebufferWidth) - 1;
+    int lastY = static_cast<int>(framebufferHeight) - 1;
+
+    for (int iy = 0; iy <= lastY; ++iy) {
+        for (int ix = 0; ix <= lastX; ++ix) {
+            size_t index = iy * framebufferWidth + ix;
+
+            Color low = framebuffer[index].color;
+            Color high = low;
+            for (int ny = std::max(0, iy - 1); ny <= std::min(lastY, iy + 1); ++ny) {
+                for (int nx = std::max(0, ix - 1); nx <= std::min(lastX, ix + 1); ++nx) {
+                    const Color& neighbor = framebuffer[ny * framebufferWidth + nx].color;
+                    low.r = std::min(low.r, neighbor.r);
+                    low.g = std::min(low.g, neighbor.g);
+                    low.b = std::min(low.b, neighbor.b);
+                    high.r = std::max(high.r, neighbor.r);
+                    high.g = std::max(high.g, neighbor.g);
+                    high.b = std::max(high.b, neighbor.b);
+                }
+            }
+            state.neighborhoodLow[index] = low;
+            state.neighborhoodHigh[index] = high;
+
+            // Las estrellas están fijas en pantalla, el skybox gira con la
+            // cámara y los cuerpos se mueven con su matriz de modelo
+            uint8_t body = bodyIds[index];
+            state.velocities[index] = glm::vec2(0.0f);
+            if (body == OVERLAY_BODY) {
+                state.velocityValid[index] = overlayStill;
+            } else if (body == 0) {
+                state.velocityValid[index] = true;
+                if (skyboxBackground) {
+                    glm::vec4 point(static_cast<float>(ix), static_cast<float>(iy), skyDepth, 1.0f);
+                    state.velocities[index] = projectPoint(skyReprojection, point) - projectPoint(skyCurrent, point);
+                }
+            } else {
+                state.velocityValid[index] = reprojectable[body];
+                if (reprojectable[body]) {
+                    glm::vec4 point(static_cast<float>(ix), static_cast<float>(iy), framebuffer[index].z, 1.0f);
+                    state.velocities[index] = projectPoint(reprojections[body], point) - projectPoint(currentOutput, point);
+                }
+            }
+        }
+    }
+
+    // 2. Por pixel de ventana: muestra actual más cercana, historia
+    // reproyectada y limitada, y mezcla. La muestra nueva pesa más mientras
+    // más cerca cae del pixel de ventana; el peso es el menor entre el de la
+    // columna y el de la fila, así que la columna de la muestra y su peso se
+    // calculan una vez.
+    float scaleX = static_cast<float>(framebufferWidth) / SCREEN_WIDTH;
+    float scaleY = static_cast<float>(framebufferHeight) / SCREEN_HEIGHT;
+    float outputPixelsPerSample = 1.0f / std::max(scaleX, scaleY);
+
+    auto blendWeight = [outputPixelsPerSample](float sampleDistance) {
+        float distance = sampleDistance * outputPixelsPerSample;
+        float blend = TEMPORAL_MIN_BLEND + (TEMPORAL_MAX_BLEND - TEMPORAL_MIN_BLEND) * std::max(0.0f, 1.0f - 2.0f * distance);
+        return static_cast<int>(blend * 256.0f + 0.5f);
+    };
+
+    int sampleColumns[SCREEN_WIDTH];
+    int columnWeights[SCREEN_WIDTH];
+    // El pixel interno ix tiene lo que sin jitter estaría en ix - jitter
+    for (size_t ox = 0; ox < SCREEN_WIDTH; ++ox) {
+        float px = ox * scaleX;
+        sampleColumns[ox] = std::clamp(static_cast<int>(std::floor(px + state.jitter.x + 0.5f)), 0, lastX);
+        columnWeights[ox] = blendWeight(std::abs(sampleColumns[ox] - state.jitter.x - px));
+    }
+
+    const Color* history = state.history.data();
+    Color* output = state.output.data();
+    const glm::vec2* velocities = state.velocities.data();
+    const uint8_t* velocityValid = state.velocityValid.data();
+    const Color* lows = state.neighborhoodLow.data();
+    const Color* highs = state.neighborhoodHigh.data();
+    const FragColor* samples = framebuffer.data();
+    bool historyValid = state.historyValid;
+
+    for (size_t oy = 0; oy < SCREEN_HEIGHT; ++oy) {
+        float py = oy * scaleY;
+        int iy = std::clamp(static_cast<int>(std::floor(py + state.jitter.y + 0.5f)), 0, lastY);
+        int rowWeight = blendWeight(std::abs(iy - state.jitter.y - py));
+        size_t rowStart = iy * framebufferWidth;
+
+        for (size_t ox = 0; ox < SCREEN_WIDTH; ++ox) {
+            size_t index = rowStart + sampleColumns[ox];
+            const Color current = samples[index].color;
+            Color& pixel = output[oy * SCREEN_WIDTH + ox];
+
+            Color historyColor;
+            glm::vec2 velocity = velocities[index];
+            if (!historyValid || !velocityValid[index]
+                || !sampleHistory(history, ox + velocity.x, oy + velocity.y, historyColor)) {
+                pixel = current;
+                continue;
+            }
+
+            int weight = std::min(columnWeights[ox], rowWeight);
+
+            const Color low = lows[index];
+            const Color high = highs[index];
+            pixel.r = blendChannel(current.r, historyColor.r, low.r, high.r, weight);
+            pixel.g = blendChannel(current.g, historyColor.g, low.g, high.g, weight);
+            pixel.b = blendChannel(current.b, historyColor.b, low.b, high.b, weight);
+            pixel.a = 255;
+        }
+    }
+
+    state.history.swap(state.output);
+    state.historyValid = true;
+}
+
+// Guarda la cámara y los cuerpos de este cuadro para reproyectar en el siguiente
+void endTemporalFrame(TemporalState& state, const std::vector<Model>& models, const glm::mat4& view, const glm::mat4& projection) {
+    state.previousViewProjection = projection * view;
+    state.previousSkyViewProjection = projection * glm::mat4(glm::mat3(view));
+    state.previousModels.resize(models.size());
+    for (size_t i = 0; i < models.size(); ++i) {
+        state.previousModels[i] = models[i].uniforms.model;
+    }
+}
+
+// Imagen a presentar: la historia tal cual o, si se van a dibujar capas de
+// depuración encima, una copia en output para que no entren en la historia
+std::vector<Color>& temporalDisplay(TemporalState& state, bool overlays) {
+    if (!overlays)
+        return state.history;
+
+    std::copy(state.history.begin(), state.history.end(), state.output.begin());
+    return state.output;
+}
+
+void renderTemporalBuffer(SDL_Renderer* renderer, const std::vector<Color>& image) {
+    presentBuffer(renderer, SCREEN_WIDTH, SCREEN_HEIGHT, [&image](size_t i) -> const Color& {
+        return image[i];
+    });
+}
\ No newline at end of file
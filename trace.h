@@ -0,0 +1,145 @@
+#pragma once
+#include <SDL.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Trazas por etapa en formato Chrome Trace Event (JSON), para abrirlas en
+// chrome://tracing o en Perfetto. Cada hilo escribe en su propio buffer
+// circular sin bloquear; solo se registra la primera vez que traza. Fuera
+// del rango de cuadros pedido, un TraceScope solo revisa un bool.
+constexpr size_t TRACE_BUFFER_EVENTS = 1 << 16; // por hilo; los más viejos se pisan
+
+struct TraceEvent {
+    const char* name; // literal, no se copia
+    Uint64 start;
+    Uint64 end;
+    uint32_t frame;
+};
+
+struct TraceBuffer {
+    std::vector<TraceEvent> events; // TRACE_BUFFER_EVENTS, circular
+    size_t written = 0; // total escrito; si pasa la capacidad se perdieron los más viejos
+    uint32_t thread = 0; // índice del carril en el visor
+};
+
+struct Tracer {
+    bool recording = false;
+    const char* path = nullptr;
+    size_t firstFrame = 0;
+    size_t frameCount = 60;
+    uint32_t frame = 0;
+    Uint64 origin = 0;
+
+    // Uno por hilo que trazó alguna vez; los hilos de parallelFor son
+    // siempre los mismos, así que no crecen
+    std::mutex buffersMutex;
+    std::vector<std::unique_ptr<TraceBuffer>> buffers;
+};
+
+Tracer tracer;
+
+TraceBuffer& traceBuffer() {
+    thread_local TraceBuffer* current = nullptr;
+    if (!current) {
+        std::lock_guard<std::mutex> lock(tracer.buffersMutex);
+        tracer.buffers.emplace_back(new TraceBuffer());
+        current = tracer.buffers.back().get();
+        current->events.resize(TRACE_BUFFER_EVENTS);
+        current->thread = static_cast<uint32_t>(tracer.buffers.size() - 1);
+    }
+    return *current;
+}
+
+void recordTrace(const char* name, Uint64 start, Uint64 end) {
+    TraceBuffer& buffer = traceBuffer();
+    buffer.events[buffer.written % TRACE_BUFFER_EVENTS] = TraceEvent{name, start, end, tracer.frame};
+    ++buffer.written;
+}
+
+// Mide desde su construcción hasta stop() o hasta salir del bloque
+class TraceScope {
+public:
+    explicit TraceScope(const char* name) : name(name), start(tracer.recording ? SDL_GetPerformanceCounter() : 0) {}
+
+    ~TraceScope() {
+        stop();
+    }
+
+    void stop() {
+        if (start != 0) {
+            recordTrace(name, start, SDL_GetPerformanceCounter());
+            start = 0;
+        }
+    }
+
+private:
+    const char* name;
+    Uint64 start;
+};
+
+// Escribe todos los eventos guardados; los de cada hilo salen del más viejo
+// al más nuevo. false si no se pudo abrir el archivo.
+bool writeTrace(const Tracer& tracer, const char* path) {
+    FILE* file = std::fopen(path, "w");
+    if (!file)
+        return false;
+
+    double microseconds = 1e6 / static_cast<double>(SDL_GetPerformanceFrequency());
+    std::fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    std::fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"Celestial Bodies Renderer\"}}");
+
+    for (const std::unique_ptr<TraceBuffer>& buffer : tracer.buffers) {
+        std::fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s %u\"}}",
+                     buffer->thread, buffer->thread == 0 ? "main" : "worker", buffer->thread);
+
+        size_t count = std::min(buffer->written, TRACE_BUFFER_EVENTS);
+        for (size_t i = buffer->written - count; i < buffer->written; ++i) {
+            const TraceEvent& event = buffer->events[i % TRACE_BUFFER_EVENTS];
+            std::fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"frame\":%u}}",
+                         event.name, buffer->thread,
+                         (event.start - tracer.origin) * microseconds, (event.end - event.start) * microseconds,
+                         event.frame);
+        }
+        if (buffer->written > TRACE_BUFFER_EVENTS) {
+            std::fprintf(stderr, "Traza: se perdieron %zu eventos del hilo %u\n", buffer->written - TRACE_BUFFER_EVENTS, buffer->thread);
+        }
+    }
+
+    std::fprintf(file, "\n]}\n");
+    return std::fclose(file) == 0;
+}
+
+// Escribe la traza pedida y deja de grabar; también se llama al salir por si
+// la corrida terminó antes que el rango
+void finishTrace(Tracer& tracer) {
+    if (!tracer.path)
+        return;
+
+    tracer.recording = false;
+    if (!writeTrace(tracer, tracer.path)) {
+        std::fprintf(stderr, "Error: no se pudo guardar la traza en %s\n", tracer.path);
+    }
+    tracer.path = nullptr;
+}
+
+// Al empezar cada cuadro: graba solo dentro de [firstFrame, firstFrame +
+// frameCount) y escribe el archivo en cuanto el rango termina. El hilo
+// principal se registra primero para quedar en el carril 0.
+void beginTraceFrame(Tracer& tracer, size_t frame) {
+    if (!tracer.path)
+        return;
+
+    tracer.frame = static_cast<uint32_t>(frame);
+    if (frame == tracer.firstFrame) {
+        tracer.origin = SDL_GetPerformanceCounter();
+        tracer.recording = true;
+        traceBuffer();
+    } else if (tracer.recording && frame == tracer.firstFrame + tracer.frameCount) {
+        finishTrace(tracer);
+    }
+}
\ No newline at end of file
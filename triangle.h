@@ -1,85 +1,279 @@
 #pragma once
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
 #include <vector>
 #include "glm/glm.hpp"
+#include "arena.h"
 #include "line.h"
 #include "framebuffer.h"
 #include "color.h"
 
 glm::vec3 L = glm::vec3(0.0f, 0.0f, 1.0f);
 
-std::pair<float, float> barycentricCoordinates(const glm::ivec2& P, const glm::vec3& A, const glm::vec3& B, const glm::vec3& C) {
-    glm::vec3 bary = glm::cross(
-            glm::vec3(C.x - A.x, B.x - A.x, A.x - P.x),
-            glm::vec3(C.y - A.y, B.y - A.y, A.y - P.y)
-    );
+// Normaliza con una raíz cuadrada inversa aproximada y un paso de Newton
+// (error relativo < 0.2%); suficiente para iluminar y comparar normales.
+constexpr bool USE_FAST_NORMALIZE = true;
 
-    if (abs(bary.z) < 1) {
-        return std::make_pair(-1, -1);
-    }
+glm::vec3 fastNormalize(const glm::vec3& v) {
+    float lengthSquared = glm::dot(v, v);
+    uint32_t bits = std::bit_cast<uint32_t>(lengthSquared);
+    float inverse = std::bit_cast<float>(0x5f3759df - (bits >> 1));
+    inverse *= 1.5f - 0.5f * lengthSquared * inverse * inverse;
+    return v * inverse;
+}
 
-    return std::make_pair(
-            bary.y / bary.z,
-            bary.x / bary.z
-    );
+// Atributo dividido entre w, que sí es lineal en pantalla:
+// valor / w = base + dx * x + dy * y
+struct AttributePlane {
+    glm::vec3 base;
+    glm::vec3 dx;
+    glm::vec3 dy;
+};
+
+// Las posiciones se redondean a punto fijo 28.4 (1/16 de pixel) y la
+// cobertura se decide con aritmética entera exacta, así dos triángulos que
+// comparten una arista nunca cubren el mismo pixel ni dejan huecos.
+constexpr int SUBPIXEL_BITS = 4;
+constexpr int64_t SUBPIXEL_SCALE = 1 << SUBPIXEL_BITS;
+// Vértices más lejos que esto (en pixeles) se descartan para no desbordar
+constexpr float FIXED_POINT_GUARD = 1 << 20;
+
+struct FixedPoint {
+    int64_t x;
+    int64_t y;
+};
+
+// Función de arista entera evaluada en el centro de muestreo del pixel (x, y):
+// valor = c + dx * x + dy * y; el pixel está dentro si es >= 0 en las tres
+struct EdgeFunction {
+    int64_t dx;
+    int64_t dy;
+    int64_t c;
+};
+
+// Todo lo que el rasterizador necesita de un triángulo, calculado una vez en
+// el setup. Los triángulos se guardan seguidos en un solo arreglo.
+struct TriangleSetup {
+    EdgeFunction edges[3];
+
+    int startX, startY, endX, endY; // caja recortada al framebuffer
+    float nearestZ;
+
+    float z[3]; // plano de profundidad (constante, dx, dy)
+    float invW[3]; // plano de 1 / w, para recuperar los atributos
+    AttributePlane normal;
+    // Solo se calculan los que pide el material
+    AttributePlane originalPos;
+    AttributePlane worldPos;
+};
+
+AttributePlane attributePlane(const glm::vec3 weights[3], const glm::vec3& a, const glm::vec3& b, const glm::vec3& c) {
+    return AttributePlane{
+            a * weights[0].z + b * weights[1].z + c * weights[2].z,
+            a * weights[0].x + b * weights[1].x + c * weights[2].x,
+            a * weights[0].y + b * weights[1].y + c * weights[2].y
+    };
 }
 
-std::vector<Fragment> triangle(const Vertex& a, const Vertex& b, const Vertex& c) {
-    std::vector<Fragment> fragments;
+glm::vec3 evaluatePlane(const AttributePlane& plane, float x, float y) {
+    return plane.base + plane.dx * x + plane.dy * y;
+}
+
+// Arista de p0 a p1, positiva del lado interior. Con la regla top-left las
+// aristas que no son superiores ni izquierdas excluyen los pixeles que caen
+// justo encima, que le tocan al triángulo vecino.
+EdgeFunction edgeFunction(const FixedPoint& p0, const FixedPoint& p1) {
+    int64_t ex = p1.x - p0.x;
+    int64_t ey = p1.y - p0.y;
+    bool topLeft = ey < 0 || (ey == 0 && ex < 0);
+
+    return EdgeFunction{
+            -ey * SUBPIXEL_SCALE,
+            ex * SUBPIXEL_SCALE,
+            ey * p0.x - ex * p0.y - (topLeft ? 0 : 1)
+    };
+}
+
+FixedPoint toFixedPoint(const glm::vec3& position) {
+    return FixedPoint{
+            static_cast<int64_t>(std::lround(position.x * SUBPIXEL_SCALE)),
+            static_cast<int64_t>(std::lround(position.y * SUBPIXEL_SCALE))
+    };
+}
+
+glm::vec2 snappedPosition(const FixedPoint& point) {
+    return glm::vec2(point.x, point.y) / static_cast<float>(SUBPIXEL_SCALE);
+}
+
+// Prepara el triángulo; devuelve false si no produce ningún fragmento
+// (degenerado, fuera de pantalla o tapado según el Z jerárquico).
+template <unsigned Varyings>
+bool setupTriangle(const Vertex& a, const Vertex& b, const Vertex& c, TriangleSetup& setup) {
     glm::vec3 A = a.position;
     glm::vec3 B = b.position;
     glm::vec3 C = c.position;
 
-    float minX = std::min(std::min(A.x, B.x), C.x);
-    float minY = std::min(std::min(A.y, B.y), C.y);
-    float maxX = std::max(std::max(A.x, B.x), C.x);
-    float maxY = std::max(std::max(A.y, B.y), C.y);
+    for (const glm::vec3* position : {&A, &B, &C}) {
+        if (!(std::abs(position->x) < FIXED_POINT_GUARD && std::abs(position->y) < FIXED_POINT_GUARD))
+            return false;
+    }
 
-    // Iterate over each point in the bounding box
-    for (int y = static_cast<int>(std::ceil(minY)); y <= static_cast<int>(std::floor(maxY)); ++y) {
-        for (int x = static_cast<int>(std::ceil(minX)); x <= static_cast<int>(std::floor(maxX)); ++x) {
-            if (x < 0 || y < 0 || y > SCREEN_HEIGHT || x > SCREEN_WIDTH)
-                continue;
+    FixedPoint p0 = toFixedPoint(A);
+    FixedPoint p1 = toFixedPoint(B);
+    FixedPoint p2 = toFixedPoint(C);
 
-            glm::ivec2 P(x, y);
-            auto barycentric = barycentricCoordinates(P, A, B, C);
-            float w = 1 - barycentric.first - barycentric.second;
-            float v = barycentric.first;
-            float u = barycentric.second;
-            float epsilon = 1e-10;
+    // Área doble con signo en unidades de subpixel; se ordenan los vértices
+    // para que el interior quede del lado positivo de las tres aristas
+    int64_t fixedArea = (p1.x - p0.x) * (p2.y - p0.y) - (p1.y - p0.y) * (p2.x - p0.x);
+    if (fixedArea == 0)
+        return false;
+    if (fixedArea < 0)
+        std::swap(p1, p2);
 
-            if (w < epsilon || v < epsilon || u < epsilon)
+    setup.edges[0] = edgeFunction(p1, p2);
+    setup.edges[1] = edgeFunction(p2, p0);
+    setup.edges[2] = edgeFunction(p0, p1);
+
+    // Caja en pixeles enteros: ceil del mínimo y floor del máximo. Con MSAA
+    // las muestras llegan hasta medio pixel del punto de muestreo.
+    int64_t pad = msaaSamples > 1 ? SUBPIXEL_SCALE / 2 : 0;
+    int64_t minX = std::min(std::min(p0.x, p1.x), p2.x) - pad;
+    int64_t minY = std::min(std::min(p0.y, p1.y), p2.y) - pad;
+    int64_t maxX = std::max(std::max(p0.x, p1.x), p2.x) + pad;
+    int64_t maxY = std::max(std::max(p0.y, p1.y), p2.y) + pad;
+
+    setup.startX = static_cast<int>(std::max<int64_t>(0, (minX + SUBPIXEL_SCALE - 1) >> SUBPIXEL_BITS));
+    setup.startY = static_cast<int>(std::max<int64_t>(0, (minY + SUBPIXEL_SCALE - 1) >> SUBPIXEL_BITS));
+    setup.endX = static_cast<int>(std::min<int64_t>(framebufferWidth - 1, maxX >> SUBPIXEL_BITS));
+    setup.endY = static_cast<int>(std::min<int64_t>(framebufferHeight - 1, maxY >> SUBPIXEL_BITS));
+    if (setup.startX > setup.endX || setup.startY > setup.endY)
+        return false;
+
+    // Si el triángulo queda detrás de todos los tiles que toca, se descarta entero
+    setup.nearestZ = std::min(std::min(A.z, B.z), C.z);
+    if (depthRectOccludes(setup.startX, setup.startY, setup.endX, setup.endY, setup.nearestZ))
+        return false;
+
+    // Pesos baricéntricos como planos (dx, dy, constante) en pixeles, a partir
+    // de las posiciones ya redondeadas. Peso de B y C; el de A es lo que falta
+    // para sumar 1.
+    glm::vec2 sA = snappedPosition(toFixedPoint(A));
+    glm::vec2 sB = snappedPosition(toFixedPoint(B));
+    glm::vec2 sC = snappedPosition(toFixedPoint(C));
+    float area = (sC.x - sA.x) * (sB.y - sA.y) - (sB.x - sA.x) * (sC.y - sA.y);
+
+    glm::vec3 weights[3];
+    weights[1] = glm::vec3(
+            -(sC.y - sA.y) / area,
+            (sC.x - sA.x) / area,
+            (sA.x * (sC.y - sA.y) - (sC.x - sA.x) * sA.y) / area
+    );
+    weights[2] = glm::vec3(
+            (sB.y - sA.y) / area,
+            -(sB.x - sA.x) / area,
+            ((sB.x - sA.x) * sA.y - sA.x * (sB.y - sA.y)) / area
+    );
+    weights[0] = glm::vec3(
+            -weights[1].x - weights[2].x,
+            -weights[1].y - weights[2].y,
+            1.0f - weights[1].z - weights[2].z
+    );
+
+    setup.z[0] = A.z * weights[0].z + B.z * weights[1].z + C.z * weights[2].z;
+    setup.z[1] = A.z * weights[0].x + B.z * weights[1].x + C.z * weights[2].x;
+    setup.z[2] = A.z * weights[0].y + B.z * weights[1].y + C.z * weights[2].y;
+
+    // La profundidad en pantalla ya es lineal; los atributos se interpolan
+    // divididos entre w para que no se deformen con la perspectiva
+    setup.invW[0] = a.invW * weights[0].z + b.invW * weights[1].z + c.invW * weights[2].z;
+    setup.invW[1] = a.invW * weights[0].x + b.invW * weights[1].x + c.invW * weights[2].x;
+    setup.invW[2] = a.invW * weights[0].y + b.invW * weights[1].y + c.invW * weights[2].y;
+
+    setup.normal = attributePlane(weights, a.normal * a.invW, b.normal * b.invW, c.normal * c.invW);
+    if constexpr ((Varyings & VARYING_ORIGINAL_POS) != 0) {
+        setup.originalPos = attributePlane(weights, a.originalPos * a.invW, b.originalPos * b.invW, c.originalPos * c.invW);
+    }
+    if constexpr ((Varyings & VARYING_WORLD_POS) != 0) {
+        setup.worldPos = attributePlane(weights, a.worldPos * a.invW, b.worldPos * b.invW, c.worldPos * c.invW);
+    }
+    return true;
+}
+
+// Agrega los fragmentos del triángulo al final de fragments
+template <unsigned Varyings>
+void rasterizeTriangle(const TriangleSetup& setup, FrameVector<Fragment>& fragments) {
+    // Cuánto cambia cada arista en cada muestra MSAA respecto al punto de
+    // muestreo del pixel
+    const SamplePattern& pattern = samplePattern(msaaSamples);
+    int64_t sampleOffsets[3][MSAA_MAX_SAMPLES];
+    for (int i = 0; i < 3; ++i) {
+        for (int s = 0; s < pattern.count; ++s) {
+            sampleOffsets[i][s] = (setup.edges[i].dx * pattern.offsets[s][0] + setup.edges[i].dy * pattern.offsets[s][1]) / SUBPIXEL_SCALE;
+        }
+    }
+
+    for (int y = setup.startY; y <= setup.endY; ++y) {
+        // Valor de cada arista al inicio de la fila; en la fila solo cambia x
+        int64_t row0 = setup.edges[0].dy * y + setup.edges[0].c;
+        int64_t row1 = setup.edges[1].dy * y + setup.edges[1].c;
+        int64_t row2 = setup.edges[2].dy * y + setup.edges[2].c;
+
+        for (int x = setup.startX; x <= setup.endX; ++x) {
+            // Salta bloques de 8x8 que ya están tapados
+            if ((x == setup.startX || x % DEPTH_TILE_SIZE == 0) && depthTileOccludes(x / DEPTH_TILE_SIZE, y / DEPTH_TILE_SIZE, setup.nearestZ)) {
+                x = static_cast<int>((x / DEPTH_TILE_SIZE + 1) * DEPTH_TILE_SIZE) - 1;
                 continue;
+            }
+
+            int64_t e0 = row0 + setup.edges[0].dx * x;
+            int64_t e1 = row1 + setup.edges[1].dx * x;
+            int64_t e2 = row2 + setup.edges[2].dx * x;
 
-            double z = A.z * w + B.z * v + C.z * u;
+            uint32_t coverage = 0;
+            if (pattern.count == 1) {
+                if (e0 < 0 || e1 < 0 || e2 < 0)
+                    continue;
+                coverage = 1;
+            } else {
+                for (int s = 0; s < pattern.count; ++s) {
+                    if (e0 + sampleOffsets[0][s] >= 0 && e1 + sampleOffsets[1][s] >= 0 && e2 + sampleOffsets[2][s] >= 0)
+                        coverage |= 1u << s;
+                }
+                if (coverage == 0)
+                    continue;
+            }
 
-            glm::vec3 normal = glm::normalize(
-                    a.normal * w + b.normal * v + c.normal * u
-            );
+            float z = setup.z[0] + setup.z[1] * x + setup.z[2] * y;
+
+            // Al normalizar se cancela el factor 1 / w, no hace falta dividir
+            glm::vec3 weightedNormal = evaluatePlane(setup.normal, x, y);
+            glm::vec3 normal = USE_FAST_NORMALIZE ? fastNormalize(weightedNormal) : glm::normalize(weightedNormal);
 
-            // glm::vec3 normal = a.normal; // assume flatness
             float intensity = glm::dot(normal, L);
 
             if (intensity < 0)
                 continue;
 
-            Color color = Color(255, 255, 255);
-
-            glm::vec3 worldPos = a.worldPos * w + b.worldPos * v + c.worldPos * u;
-            glm::vec3 originalPos = a.originalPos * w + b.originalPos * v + c.originalPos * u;
-            if (P.x >= 0 && P.y >= 0 && P.x < SCREEN_WIDTH && P.y < SCREEN_HEIGHT)
-                fragments.push_back(
-                        Fragment{
-                                static_cast<uint16_t>(P.x),
-                                static_cast<uint16_t>(P.y),
-                                z,
-                                color,
-                                intensity,
-                                worldPos,
-                                originalPos,
-                                normal
-                        }
-                );
+            float clipW = 1.0f / (setup.invW[0] + setup.invW[1] * x + setup.invW[2] * y);
+
+            Fragment& fragment = fragments.emplace_back();
+            fragment.x = static_cast<uint16_t>(x);
+            fragment.y = static_cast<uint16_t>(y);
+            fragment.z = z;
+            fragment.intensity = intensity;
+            fragment.color = Color(255, 255, 255);
+            fragment.coverage = coverage;
+            fragment.dzdx = setup.z[1];
+            fragment.dzdy = setup.z[2];
+            fragment.normal = normal;
+            if constexpr ((Varyings & VARYING_ORIGINAL_POS) != 0) {
+                fragment.originalPos = evaluatePlane(setup.originalPos, x, y) * clipW;
+            }
+            if constexpr ((Varyings & VARYING_WORLD_POS) != 0) {
+                fragment.worldPos = evaluatePlane(setup.worldPos, x, y) * clipW;
+            }
         }
     }
-    return fragments;
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
 #pragma once
+#include <SDL.h>
 #include "glm/glm.hpp"
 
 struct Uniform {
@@ -6,4 +7,9 @@ struct Uniform {
     glm::mat4 view;
     glm::mat4 projection;
     glm::mat4 viewport;
-};
\ No newline at end of file
+};
+
+// Tiempo de la escena en milisegundos para lo que se anima con el reloj (los
+// shaders y el cache de sombreado). El ciclo principal lo fija una vez por
+// cuadro: SDL_GetTicks() en vivo o el valor grabado al reproducir.
+Uint32 sceneTicks = 0;
\ No newline at end of file
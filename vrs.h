@@ -0,0 +1,61 @@
+#pragma once
+#include <vector>
+#include <SDL.h>
+#include "glm/glm.hpp"
+#include "color.h"
+#include "fragment.h"
+#include "framebuffer.h"
+
+// Sombreado de tasa variable: con tasa N se sombrea un solo fragmento por
+// bloque de NxN pixeles y el resto del bloque reutiliza su color sin
+// iluminar. Profundidad, cobertura e iluminación siguen siendo por pixel.
+bool variableRateShadingEnabled = true;
+
+struct ShadingRateSample {
+    Color albedo;
+    Uint32 stamp; // dibujo al que pertenece la muestra
+    glm::vec3 normal;
+};
+
+struct ShadingRateBuffer {
+    int rate = 1;
+    size_t blocksWide = 0;
+    Uint32 stamp = 0;
+    std::vector<ShadingRateSample> samples;
+};
+
+ShadingRateBuffer shadingRateBuffer;
+
+// Se llama al empezar a dibujar un modelo. Las muestras de dibujos anteriores
+// quedan invalidadas al cambiar el stamp.
+void beginShadingRate(int rate) {
+    ShadingRateBuffer& buffer = shadingRateBuffer;
+    buffer.rate = variableRateShadingEnabled ? rate : 1;
+    if (buffer.rate <= 1) {
+        return;
+    }
+
+    size_t blocksWide = (framebufferWidth + buffer.rate - 1) / buffer.rate;
+    size_t blocksHigh = (framebufferHeight + buffer.rate - 1) / buffer.rate;
+    if (buffer.samples.size() != blocksWide * blocksHigh || buffer.blocksWide != blocksWide) {
+        buffer.blocksWide = blocksWide;
+        buffer.samples.assign(blocksWide * blocksHigh, ShadingRateSample{Color(), 0, glm::vec3(0.0f)});
+        buffer.stamp = 0;
+    }
+
+    ++buffer.stamp;
+}
+
+// Muestra del bloque que contiene al fragmento. valid queda en false si hay
+// que sombrear y guardar el resultado en esa muestra. Una muestra solo se
+// reutiliza si su normal se parece a la del fragmento, así las caras
+// traseras o el otro lado de una silueta no heredan el color equivocado.
+ShadingRateSample* findShadingRateSample(const Fragment& fragment, bool& valid) {
+    ShadingRateBuffer& buffer = shadingRateBuffer;
+    size_t blockX = fragment.x / buffer.rate;
+    size_t blockY = fragment.y / buffer.rate;
+    ShadingRateSample& sample = buffer.samples[blockY * buffer.blocksWide + blockX];
+
+    valid = sample.stamp == buffer.stamp && glm::dot(sample.normal, fragment.normal) > 0.9f;
+    return &sample;
+}
\ No newline at end of file